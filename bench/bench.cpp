@@ -0,0 +1,55 @@
+#include "bench.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<int64_t> allocation_count{0};
+std::atomic<int64_t> allocation_bytes{0};
+
+void count_allocation(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  allocation_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+}
+} // namespace
+
+namespace kl::bench {
+AllocationCounters allocation_counters() {
+  return {.allocations = allocation_count.load(std::memory_order_relaxed),
+          .bytes = allocation_bytes.load(std::memory_order_relaxed)};
+}
+} // namespace kl::bench
+
+#ifdef __GLIBC__
+// Arrays of trivially relocatable items allocate with malloc and realloc (see kl/memory/blocks.hpp); those are
+// counted too, and operator new goes around them to be counted once.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size) {
+  count_allocation(size);
+  return __libc_malloc(size);
+}
+void* realloc(void* ptr, size_t size) {
+  count_allocation(size);
+  return __libc_realloc(ptr, size);
+}
+}
+#define KL_BENCH_MALLOC __libc_malloc
+#else
+#define KL_BENCH_MALLOC std::malloc
+#endif
+
+void* operator new(size_t size) {
+  count_allocation(size);
+  if (auto ptr = KL_BENCH_MALLOC(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return ::operator new(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
@@ -0,0 +1,44 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+namespace kl::bench {
+
+struct AllocationCounters {
+  int64_t allocations = 0;
+  int64_t bytes = 0;
+};
+
+// Counters of the global operator new, replaced in bench.cpp.
+AllocationCounters allocation_counters();
+
+template <typename T>
+inline void do_not_optimize(T& value) {
+  asm volatile("" : "+m"(value) : : "memory");
+}
+
+struct Result {
+  double ns_per_op = 0;
+  double allocations_per_op = 0;
+};
+
+template <typename Fn>
+Result measure(int64_t iterations, Fn&& fn) {
+  auto counters = allocation_counters();
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < iterations; i++) {
+    fn(i);
+  }
+  auto duration = std::chrono::steady_clock::now() - start;
+  auto allocations = allocation_counters().allocations - counters.allocations;
+  return {.ns_per_op = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) /
+                       static_cast<double>(iterations),
+          .allocations_per_op = static_cast<double>(allocations) / static_cast<double>(iterations)};
+}
+
+inline void report(const char* name, const Result& result) {
+  std::printf("%-48s %10.2f ns/op %8.3f allocs/op\n", name, result.ns_per_op, result.allocations_per_op);
+}
+
+} // namespace kl::bench
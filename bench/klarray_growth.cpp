@@ -0,0 +1,79 @@
+#include "bench.hpp"
+#include <kl/ds/array.hpp>
+#include <kl/text.hpp>
+#include <string>
+
+using namespace kl;
+
+namespace {
+constexpr TSize Items = 200'000;
+constexpr TSize Inserts = 5'000;
+constexpr TSize Samples = 32 << 20;
+
+// The same Text, without the relocation trait: items are moved and destroyed one by one.
+struct MovedText {
+  Text value;
+};
+static_assert(!is_trivially_relocatable<MovedText>);
+
+// A sample that is copied item by item when its Array grows.
+struct CopiedSample {
+  int64_t value;
+  CopiedSample(int64_t v) : value(v) {}
+  CopiedSample(const CopiedSample& other) : value(other.value) {}
+};
+static_assert(!is_trivially_relocatable<CopiedSample>);
+
+Text heap_text() {
+  std::string value(40, 'x');
+  return {value.data(), static_cast<TSize>(value.size())};
+}
+
+template <typename T>
+bench::Result growth() {
+  auto text = heap_text();
+  return bench::measure(10, [&](int64_t) {
+    Array<T> items;
+    for (TSize i = 0; i < Items; i++) {
+      items.push_back(T{text});
+    }
+    bench::do_not_optimize(items);
+  });
+}
+
+template <typename T>
+bench::Result front_inserts() {
+  auto text = heap_text();
+  return bench::measure(10, [&](int64_t) {
+    Array<T> items;
+    for (TSize i = 0; i < Inserts; i++) {
+      items.insert(0, T{text});
+    }
+    while (items.size() > 0) {
+      items.remove_at(0);
+    }
+    bench::do_not_optimize(items);
+  });
+}
+// Appends 256 MB of samples: the growth steps past MappedBlockSize extend or remap the block instead of copying it.
+template <typename T>
+bench::Result samples() {
+  return bench::measure(1, [&](int64_t) {
+    Array<T> items;
+    for (TSize i = 0; i < Samples; i++) {
+      items.push_back(T(i));
+    }
+    bench::do_not_optimize(items);
+  });
+}
+} // namespace
+
+int main() {
+  bench::report("200k push_back, Array<Text>", growth<Text>());
+  bench::report("200k push_back, Array<MovedText>", growth<MovedText>());
+  bench::report("5k front insert+remove, Array<Text>", front_inserts<Text>());
+  bench::report("5k front insert+remove, Array<MovedText>", front_inserts<MovedText>());
+  bench::report("32M push_back, Array<int64_t>", samples<int64_t>());
+  bench::report("32M push_back, Array<CopiedSample>", samples<CopiedSample>());
+  return 0;
+}
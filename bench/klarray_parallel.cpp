@@ -0,0 +1,63 @@
+#include "bench.hpp"
+#include <kl/ds/algorithms.hpp>
+#include <cstdio>
+#include <random>
+
+using namespace kl;
+
+namespace {
+constexpr TSize Items = 4 << 20;
+
+Array<int64_t> random_items() {
+  std::mt19937_64 rng(42);
+  Array<int64_t> items(TagReserve{}, Items);
+  for (TSize i = 0; i < Items; i++) {
+    items.push_back(static_cast<int64_t>(rng() >> 1));
+  }
+  return items;
+}
+
+// Runs an algorithm over 4M items sequentially, then on pools of 1 to 32 threads. algorithm takes the Parallel
+// argument, if any, of the call it makes.
+void run(const char* name, auto&& algorithm) {
+  char label[64];
+  std::snprintf(label, sizeof(label), "%s, sequential", name);
+  bench::report(label, bench::measure(1, [&](int64_t) { algorithm(); }));
+  for (TSize threads = 1; threads <= 32; threads *= 2) {
+    TaskPool pool(threads);
+    std::snprintf(label, sizeof(label), "%s, %d threads", name, threads);
+    bench::report(label, bench::measure(1, [&](int64_t) { algorithm(Parallel{pool}); }));
+  }
+}
+} // namespace
+
+int main() {
+  auto items = random_items();
+  auto square = [](int64_t value) { return (value & 0xFFFF) * (value & 0xFFFF); };
+  auto sum = [](int64_t total, int64_t value) { return total + value; };
+  auto even = [](int64_t value) { return value % 2 == 0; };
+
+  run("sort", [&](auto... parallel) {
+    auto copy = items;
+    kl::sort(parallel..., copy);
+    bench::do_not_optimize(copy);
+  });
+  run("transform", [&](auto... parallel) {
+    auto result = kl::transform(parallel..., items, square);
+    bench::do_not_optimize(result);
+  });
+  run("reduce", [&](auto... parallel) {
+    auto result = kl::reduce(parallel..., items, int64_t{0}, sum);
+    bench::do_not_optimize(result);
+  });
+  run("filter", [&](auto... parallel) {
+    auto result = kl::filter(parallel..., items, even);
+    bench::do_not_optimize(result);
+  });
+  run("partition", [&](auto... parallel) {
+    auto copy = items;
+    kl::partition(parallel..., copy, even);
+    bench::do_not_optimize(copy);
+  });
+  return 0;
+}
@@ -0,0 +1,78 @@
+#include "bench.hpp"
+#include <kl/ds/dict.hpp>
+#include <kl/text.hpp>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace kl;
+
+namespace {
+constexpr TSize Keys = 100'000;
+
+// Adapters giving the standard containers the Dict vocabulary.
+template <typename Map>
+struct StdMap {
+  Map map;
+  void add(const typename Map::key_type& key, int value) { map.insert_or_assign(key, value); }
+  bool has(const typename Map::key_type& key) const { return map.contains(key); }
+  bool remove(const typename Map::key_type& key) { return map.erase(key) == 1; }
+};
+
+template <typename Key>
+struct Workload {
+  std::vector<Key> present;
+  std::vector<Key> missing;
+};
+
+Workload<uint64_t> integer_keys() {
+  Workload<uint64_t> keys;
+  for (TSize i = 0; i < Keys; i++) {
+    keys.present.push_back(static_cast<uint64_t>(i) * 0x9E3779B97F4A7C15ull);
+    keys.missing.push_back(static_cast<uint64_t>(i + Keys) * 0x9E3779B97F4A7C15ull);
+  }
+  return keys;
+}
+
+Workload<Text> text_keys() {
+  Workload<Text> keys;
+  for (TSize i = 0; i < Keys; i++) {
+    auto present = "session:" + std::to_string(i * 7) + ":user";
+    auto missing = "session:" + std::to_string(i * 7 + 3) + ":user";
+    keys.present.emplace_back(present.data(), static_cast<TSize>(present.size()));
+    keys.missing.emplace_back(missing.data(), static_cast<TSize>(missing.size()));
+  }
+  return keys;
+}
+
+template <typename Map, typename Key>
+void run(const char* name, const Workload<Key>& keys) {
+  std::string prefix = name;
+  auto label = [&](const char* operation) { return prefix + ", " + operation; };
+
+  Map map;
+  bench::report(label("insert").c_str(),
+                bench::measure(Keys, [&](int64_t i) { map.add(keys.present[i], static_cast<int>(i)); }));
+  size_t found = 0;
+  bench::report(label("lookup hit").c_str(),
+                bench::measure(Keys, [&](int64_t i) { found += map.has(keys.present[(i * 7919) % Keys]); }));
+  bench::report(label("lookup miss").c_str(),
+                bench::measure(Keys, [&](int64_t i) { found += map.has(keys.missing[(i * 7919) % Keys]); }));
+  bench::report(label("erase").c_str(), bench::measure(Keys, [&](int64_t i) { found += map.remove(keys.present[i]); }));
+  bench::do_not_optimize(found);
+}
+} // namespace
+
+int main() {
+  auto integers = integer_keys();
+  run<Dict<uint64_t, int>>("u64 kl::Dict", integers);
+  run<StdMap<std::unordered_map<uint64_t, int>>>("u64 std::unordered_map", integers);
+  run<StdMap<std::map<uint64_t, int>>>("u64 std::map", integers);
+
+  auto texts = text_keys();
+  run<Dict<Text, int>>("Text kl::Dict", texts);
+  run<StdMap<std::unordered_map<Text, int>>>("Text std::unordered_map", texts);
+  run<StdMap<std::map<Text, int>>>("Text std::map", texts);
+  return 0;
+}
@@ -0,0 +1,87 @@
+#include "bench.hpp"
+#include <kl/ds/concurrent_dict.hpp>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace kl;
+
+namespace {
+constexpr int64_t OperationsPerThread = 200'000;
+constexpr int64_t Keys = 1 << 16;
+
+// The baseline: a single Dict behind one global mutex.
+class LockedDict {
+  std::mutex m_lock;
+  Dict<int64_t, int64_t> m_items;
+
+public:
+  std::optional<int64_t> get_opt(int64_t key) {
+    std::lock_guard guard(m_lock);
+    return m_items.get_opt(key);
+  }
+  void add(int64_t key, int64_t value) {
+    std::lock_guard guard(m_lock);
+    m_items.add(key, value);
+  }
+};
+
+// Runs the threads over random keys; read_percent of the operations are lookups, the others writes.
+template <typename Map>
+bench::Result run(Map& map, int threads, int read_percent) {
+  std::vector<std::thread> workers;
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&map, t, read_percent] {
+      std::mt19937_64 rng(t);
+      int64_t found = 0;
+      for (int64_t i = 0; i < OperationsPerThread; i++) {
+        auto value = rng();
+        auto key = static_cast<int64_t>(value % Keys);
+        if (static_cast<int>((value >> 32) % 100) < read_percent) {
+          found += map.get_opt(key).has_value();
+        } else {
+          map.add(key, i);
+        }
+      }
+      bench::do_not_optimize(found);
+    });
+  }
+  for (auto& worker: workers) {
+    worker.join();
+  }
+  auto duration = std::chrono::steady_clock::now() - start;
+  return {.ns_per_op = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) /
+                       static_cast<double>(OperationsPerThread * threads)};
+}
+
+template <typename Map>
+void prefill(Map& map) {
+  for (int64_t key = 0; key < Keys; key += 2) {
+    map.add(key, key);
+  }
+}
+} // namespace
+
+int main() {
+  std::printf("%u hardware threads, %d shards; ns/op is wall time over all the operations of all threads\n",
+              std::thread::hardware_concurrency(), ConcurrentDict<int64_t, int64_t>::default_shard_count());
+  for (int read_percent: {100, 90, 50}) {
+    for (int threads: {1, 2, 4, 8, 16, 32, 64}) {
+      LockedDict locked;
+      prefill(locked);
+      ConcurrentDict<int64_t, int64_t> sharded;
+      prefill(sharded);
+      auto label = [&](const char* map) {
+        return std::string(map) + ", " + std::to_string(read_percent) + "% reads, " + std::to_string(threads) +
+               " threads";
+      };
+      bench::report(label("global mutex").c_str(), run(locked, threads, read_percent));
+      bench::report(label("ConcurrentDict").c_str(), run(sharded, threads, read_percent));
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,86 @@
+#include "bench.hpp"
+#include <kl/ds/dict.hpp>
+#include <kl/ds/flat_dict.hpp>
+#include <kl/text.hpp>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace kl;
+
+namespace {
+constexpr int64_t Lookups = 2'000'000;
+constexpr TSize Sequence = 1 << 16;
+
+// Header-like keys: a shared prefix, then a distinguishing part.
+Text make_key(Text*, TSize i) {
+  auto key = "x-request-header-" + std::to_string(i * 37 % 1000);
+  return {key.data(), static_cast<TSize>(key.size())};
+}
+int64_t make_key(int64_t*, TSize i) { return i * 37 % 1000; }
+
+// std::map with the find() returning a pointer, like the kl maps.
+template <typename Key>
+struct StdMap {
+  std::map<Key, int> map;
+  const int* find(const Key& key) const {
+    auto it = map.find(key);
+    return it == map.end() ? nullptr : &it->second;
+  }
+};
+
+template <typename Map, typename Key, typename Build>
+void run(const char* name, const std::vector<Key>& keys, Build&& build) {
+  auto before = bench::allocation_counters();
+  Map map = build();
+  auto after = bench::allocation_counters();
+  // random order, so that the branch predictor cannot learn the path through a tree
+  std::mt19937 rng(5);
+  std::vector<const Key*> lookups;
+  for (TSize i = 0; i < Sequence; i++) {
+    lookups.push_back(&keys[rng() % keys.size()]);
+  }
+  size_t found = 0;
+  auto result = bench::measure(Lookups, [&](int64_t i) { found += map.find(*lookups[i % Sequence]) != nullptr; });
+  bench::do_not_optimize(found);
+  auto label = std::string(name) + ", " + std::to_string(keys.size()) + " keys";
+  bench::report(label.c_str(), result);
+  std::printf("%-48s %10lld bytes in %lld allocations\n", "", static_cast<long long>(after.bytes - before.bytes),
+              static_cast<long long>(after.allocations - before.allocations));
+}
+
+template <typename Key>
+void run_all(const char* key_name) {
+  for (TSize count: {8, 16, 32, 256}) {
+    std::vector<Key> keys;
+    Array<Pair<Key, int>> items(TagReserve{}, count);
+    for (TSize i = 0; i < count; i++) {
+      keys.push_back(make_key(static_cast<Key*>(nullptr), i));
+      items.push_back({keys.back(), i});
+    }
+    auto label = [&](const char* map) { return std::string(key_name) + " " + map; };
+    run<FlatDict<Key, int>>(label("FlatDict").c_str(), keys, [&] { return FlatDict<Key, int>(std::move(items)); });
+    run<StdMap<Key>>(label("std::map").c_str(), keys, [&] {
+      StdMap<Key> map;
+      for (TSize i = 0; i < count; i++) {
+        map.map.emplace(keys[i], i);
+      }
+      return map;
+    });
+    run<Dict<Key, int>>(label("Dict").c_str(), keys, [&] {
+      Dict<Key, int> map;
+      for (TSize i = 0; i < count; i++) {
+        map.add(keys[i], i);
+      }
+      return map;
+    });
+  }
+}
+} // namespace
+
+int main() {
+  run_all<int64_t>("i64");
+  run_all<Text>("Text");
+  return 0;
+}
@@ -0,0 +1,78 @@
+#include "bench.hpp"
+#include <kl/memory.hpp>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace kl;
+
+namespace {
+constexpr int64_t MessagesPerThread = 2'000'000;
+// Messages alive at once on each thread; each new one replaces the oldest.
+constexpr int64_t LiveMessages = 256;
+
+struct Message {
+  int64_t id;
+  int64_t payload[5] = {};
+  explicit Message(int64_t id) : id(id) {}
+};
+
+// Each thread keeps a window of live messages from make(), replacing the oldest with a new one at each step.
+template <typename Make>
+bench::Result run(int threads, Make make) {
+  using Ptr = decltype(make(0));
+  std::vector<std::thread> workers;
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&] {
+      std::vector<Ptr> live;
+      live.reserve(LiveMessages);
+      for (int64_t i = 0; i < LiveMessages; i++) {
+        live.push_back(make(i));
+      }
+      for (int64_t i = 0; i < MessagesPerThread; i++) {
+        live[i % LiveMessages] = make(i);
+        bench::do_not_optimize(live[i % LiveMessages]);
+      }
+    });
+  }
+  for (auto& worker: workers) {
+    worker.join();
+  }
+  auto duration = std::chrono::steady_clock::now() - start;
+  return {.ns_per_op = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) /
+                       static_cast<double>(MessagesPerThread * threads)};
+}
+} // namespace
+
+int main() {
+  std::printf("%u hardware threads; ns/op is wall time per message created and destroyed, over all threads\n",
+              std::thread::hardware_concurrency());
+  ObjectPool pool(ShareableBlockSize<Message>);
+  auto& sized = SizedObjectPools::shared();
+  for (int threads: {1, 2, 4, 8}) {
+    auto label = [&](const char* kind) { return std::string(kind) + ", " + std::to_string(threads) + " threads"; };
+    bench::report(label("make_ptr, new").c_str(), run(threads, [](int64_t id) { return make_ptr<Message>(id); }));
+    bench::report(label("make_ptr, pool").c_str(),
+                  run(threads, [&](int64_t id) { return make_ptr<Message>(pool, id); }));
+    bench::report(label("make_ptr, sized pools").c_str(),
+                  run(threads, [&](int64_t id) { return make_ptr<Message>(sized, id); }));
+    bench::report(label("make_atomic_mutable_shareable, new").c_str(),
+                  run(threads, [](int64_t id) { return make_atomic_mutable_shareable<Message>(id); }));
+    bench::report(label("make_atomic_mutable_shareable, pool").c_str(),
+                  run(threads, [&](int64_t id) { return make_atomic_mutable_shareable<Message>(pool, id); }));
+  }
+
+  // blocks made on one thread and released on another, as with messages handed to a consumer
+  std::vector<UniquePointer<Message, PoolDeleter<Message>>> handed(MessagesPerThread);
+  auto produced = bench::measure(MessagesPerThread, [&](int64_t i) { handed[i] = make_ptr<Message>(pool, i); });
+  auto start = std::chrono::steady_clock::now();
+  std::thread([&] { handed.clear(); }).join();
+  auto consumed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  bench::report("pool, producer thread", produced);
+  bench::report("pool, consumer thread",
+                {.ns_per_op = static_cast<double>(consumed.count()) / static_cast<double>(MessagesPerThread)});
+  return 0;
+}
@@ -0,0 +1,81 @@
+#include "bench.hpp"
+#include <kl/memory.hpp>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace kl;
+
+namespace {
+constexpr int64_t CopiesPerThread = 2'000'000;
+
+struct Counted : RefCounted<Counted> {
+  int64_t value = 1;
+};
+struct AtomicCounted : RefCounted<AtomicCounted, RefCounting::Atomic> {
+  int64_t value = 1;
+};
+
+// Each thread copies and drops pointers to the object make() returns: its own object, or, with a shared source,
+// one object for all the threads, whose count they all update.
+template <typename Ptr>
+bench::Result run(int threads, const Ptr* shared_source, auto&& make) {
+  std::vector<std::thread> workers;
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&] {
+      auto own = make();
+      const Ptr& source = shared_source != nullptr ? *shared_source : own;
+      for (int64_t i = 0; i < CopiesPerThread; i++) {
+        Ptr copy(source);
+        bench::do_not_optimize(copy);
+      }
+    });
+  }
+  for (auto& worker: workers) {
+    worker.join();
+  }
+  auto duration = std::chrono::steady_clock::now() - start;
+  return {.ns_per_op = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) /
+                       static_cast<double>(CopiesPerThread * threads)};
+}
+} // namespace
+
+int main() {
+  std::printf("%u hardware threads; ns/op is wall time per copy and destruction, over all threads\n",
+              std::thread::hardware_concurrency());
+  auto make_local = [] { return make_mutable_shareable<int64_t>(1); };
+  auto make_atomic = [] { return make_atomic_mutable_shareable<int64_t>(1); };
+  auto make_array = [] { return AtomicSharedArrayPointer<int64_t>(16); };
+  auto make_local_intrusive = [] { return make_intrusive<Counted>(); };
+  auto make_atomic_intrusive = [] { return make_intrusive<AtomicCounted>(); };
+  auto shared = make_atomic();
+  auto shared_array = make_array();
+  auto shared_intrusive = make_atomic_intrusive();
+  for (int threads: {1, 2, 4, 8, 16, 32}) {
+    auto label = [&](const char* kind) { return std::string(kind) + ", " + std::to_string(threads) + " threads"; };
+    bench::report(label("local count, own object").c_str(), run<decltype(make_local())>(threads, nullptr, make_local));
+    bench::report(label("atomic count, own object").c_str(), run<decltype(shared)>(threads, nullptr, make_atomic));
+    bench::report(label("atomic count, shared object").c_str(), run(threads, &shared, make_atomic));
+    bench::report(label("atomic array, shared object").c_str(), run(threads, &shared_array, make_array));
+    bench::report(label("local intrusive, own object").c_str(),
+                  run<IntrusivePointer<Counted>>(threads, nullptr, make_local_intrusive));
+    bench::report(label("atomic intrusive, shared object").c_str(),
+                  run(threads, &shared_intrusive, make_atomic_intrusive));
+  }
+
+  auto local = make_local();
+  WeakPointer<int64_t> local_weak(local);
+  AtomicWeakPointer<int64_t> atomic_weak(shared);
+  bench::report("WeakPointer::lock, local count", bench::measure(CopiesPerThread, [&](int64_t) {
+                  auto locked = local_weak.lock();
+                  bench::do_not_optimize(locked);
+                }));
+  bench::report("WeakPointer::lock, atomic count", bench::measure(CopiesPerThread, [&](int64_t) {
+                  auto locked = atomic_weak.lock();
+                  bench::do_not_optimize(locked);
+                }));
+  return 0;
+}
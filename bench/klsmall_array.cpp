@@ -0,0 +1,34 @@
+#include "bench.hpp"
+#include <kl/ds/array.hpp>
+#include <kl/ds/small_array.hpp>
+#include <kl/text.hpp>
+
+using namespace kl;
+
+namespace {
+constexpr int64_t Paths = 200'000;
+
+// Path splitting: the components of most paths fit in the inline storage of a SmallArray.
+const Text Path = "/usr/local/share/kl/config.toml"_t;
+
+template <typename List>
+bench::Result split_paths() {
+  return bench::measure(Paths, [&](int64_t) {
+    List components;
+    TSize start = 1;
+    for (TSize i = 1; i <= Path.size(); i++) {
+      if (i == Path.size() || Path[i] == '/') {
+        components.push_back(Path.subpos(start, i - 1));
+        start = i + 1;
+      }
+    }
+    bench::do_not_optimize(components);
+  });
+}
+} // namespace
+
+int main() {
+  bench::report("path split, Array<Text>", split_paths<Array<Text>>());
+  bench::report("path split, SmallArray<Text, 8>", split_paths<SmallArray<Text, 8>>());
+  return 0;
+}
@@ -0,0 +1,78 @@
+#include "bench.hpp"
+#include <kl/ds/array.hpp>
+#include <kl/ds/soa_array.hpp>
+
+using namespace kl;
+
+namespace {
+constexpr TSize Items = 1 << 20;
+
+// A 64-byte record, of which the scans read 8 or 12 bytes.
+struct Order {
+  int64_t id;
+  double price;
+  int32_t quantity;
+  int32_t flags;
+  char reference[40];
+};
+
+Array<Order> orders() {
+  Array<Order> items(TagReserve{}, Items);
+  for (TSize i = 0; i < Items; i++) {
+    items.push_back({i, static_cast<double>(i % 1000) * 0.25, i % 7, 0, {}});
+  }
+  return items;
+}
+
+SoAArray<int64_t, double, int32_t, int32_t> order_columns() {
+  SoAArray<int64_t, double, int32_t, int32_t> items(TagReserve{}, Items);
+  for (TSize i = 0; i < Items; i++) {
+    items.push_back(i, static_cast<double>(i % 1000) * 0.25, i % 7, 0);
+  }
+  return items;
+}
+} // namespace
+
+int main() {
+  auto records = orders();
+  auto columns = order_columns();
+
+  bench::report("sum of prices, Array<Order>", bench::measure(20, [&](int64_t) {
+                  double total = 0;
+                  for (const auto& order: records) {
+                    total += order.price;
+                  }
+                  bench::do_not_optimize(total);
+                }));
+  bench::report("sum of prices, SoAArray column", bench::measure(20, [&](int64_t) {
+                  double total = 0;
+                  for (auto price: columns.column<1>()) {
+                    total += price;
+                  }
+                  bench::do_not_optimize(total);
+                }));
+  bench::report("price * quantity, Array<Order>", bench::measure(20, [&](int64_t) {
+                  double total = 0;
+                  for (const auto& order: records) {
+                    total += order.price * order.quantity;
+                  }
+                  bench::do_not_optimize(total);
+                }));
+  bench::report("price * quantity, SoAArray columns", bench::measure(20, [&](int64_t) {
+                  auto prices = columns.column<1>();
+                  auto quantities = columns.column<2>();
+                  double total = 0;
+                  for (size_t i = 0; i < prices.size(); i++) {
+                    total += prices[i] * quantities[i];
+                  }
+                  bench::do_not_optimize(total);
+                }));
+  bench::report("price * quantity, SoAArray rows", bench::measure(20, [&](int64_t) {
+                  double total = 0;
+                  for (auto row: columns) {
+                    total += row.get<1>() * row.get<2>();
+                  }
+                  bench::do_not_optimize(total);
+                }));
+  return 0;
+}
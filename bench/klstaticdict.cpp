@@ -0,0 +1,59 @@
+#include "bench.hpp"
+#include <kl/ds/dict.hpp>
+#include <kl/ds/flat_dict.hpp>
+#include <kl/ds/static_dict.hpp>
+#include <random>
+#include <string_view>
+#include <vector>
+
+using namespace kl;
+
+namespace {
+constexpr int64_t Lookups = 4'000'000;
+constexpr TSize Sequence = 1 << 16;
+
+constexpr Pair<Text, int> HeaderNames[] = {
+    {"accept"_t, 0},         {"accept-encoding"_t, 1}, {"accept-language"_t, 2}, {"authorization"_t, 3},
+    {"cache-control"_t, 4},  {"connection"_t, 5},      {"content-length"_t, 6},  {"content-type"_t, 7},
+    {"cookie"_t, 8},         {"date"_t, 9},            {"etag"_t, 10},           {"host"_t, 11},
+    {"if-none-match"_t, 12}, {"origin"_t, 13},         {"referer"_t, 14},        {"user-agent"_t, 15}};
+constexpr StaticDict<int, 16> Headers(HeaderNames);
+
+// Header names as a parser sees them: views into the request, a quarter of them unknown.
+std::vector<std::string_view> make_lookups() {
+  static const char* unknown[] = {"x-request-id", "x-forwarded-for", "dnt", "upgrade-insecure-requests"};
+  std::mt19937 rng(3);
+  std::vector<std::string_view> lookups;
+  for (TSize i = 0; i < Sequence; i++) {
+    auto pick = rng() % 20;
+    lookups.push_back(pick < 16 ? HeaderNames[pick].first.to_view() : std::string_view(unknown[pick - 16]));
+  }
+  return lookups;
+}
+
+template <typename Map>
+bench::Result lookups(const Map& map, const std::vector<std::string_view>& names) {
+  int64_t sum = 0;
+  auto result = bench::measure(Lookups, [&](int64_t i) {
+    auto value = map.find(names[i % Sequence]);
+    sum += value == nullptr ? -1 : *value;
+  });
+  bench::do_not_optimize(sum);
+  return result;
+}
+} // namespace
+
+int main() {
+  auto names = make_lookups();
+  Dict<Text, int> dict;
+  Array<Pair<Text, int>> items;
+  for (const auto& item: HeaderNames) {
+    dict.add(item.first, item.second);
+    items.push_back(item);
+  }
+  FlatDict<Text, int> flat(std::move(items));
+  bench::report("header name lookup, StaticDict", lookups(Headers, names));
+  bench::report("header name lookup, Dict", lookups(dict, names));
+  bench::report("header name lookup, FlatDict", lookups(flat, names));
+  return 0;
+}
@@ -0,0 +1,41 @@
+#include "bench.hpp"
+#include <kl/text.hpp>
+#include <kl/text/arena.hpp>
+#include <kl/ds/array.hpp>
+
+using namespace kl;
+
+namespace {
+constexpr int64_t Requests = 2'000;
+constexpr TSize FieldsPerRequest = 2'000;
+const char* const Source = "GET /api/v1/metrics/cpu.load.average?host=worker-0042.example.net&window=300 HTTP/1.1";
+
+// Field lengths between 16 and 80 bytes: just above the small-text capacity, like most header values.
+TSize field_length(TSize field) { return 16 + (field * 7) % 65; }
+} // namespace
+
+int main() {
+  auto heap = bench::measure(Requests, [](int64_t) {
+    Array<Text> fields(TagReserve{}, FieldsPerRequest);
+    for (TSize i = 0; i < FieldsPerRequest; i++) {
+      fields.push_back(Text(Source, field_length(i)));
+    }
+    bench::do_not_optimize(fields);
+  });
+
+  TextArena arena;
+  auto arena_backed = bench::measure(Requests, [&arena](int64_t) {
+    {
+      Array<Text> fields(TagReserve{}, FieldsPerRequest);
+      for (TSize i = 0; i < FieldsPerRequest; i++) {
+        fields.push_back(Text(Source, field_length(i), arena));
+      }
+      bench::do_not_optimize(fields);
+    }
+    arena.reset();
+  });
+
+  bench::report("parse request into 2000 fields, heap buffers", heap);
+  bench::report("parse request into 2000 fields, TextArena", arena_backed);
+  return 0;
+}
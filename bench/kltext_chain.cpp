@@ -0,0 +1,44 @@
+#include "bench.hpp"
+#include <kl/text.hpp>
+#include <kl/text/chain.hpp>
+#include <algorithm>
+
+using namespace kl;
+
+namespace {
+constexpr int64_t Documents = 20;
+constexpr TSize Lines = 20'000;
+const Text Line = "  - name: worker-0042.example.net\n"_t;
+
+// What flattening used to do: copy every segment, every time.
+Text copy_all(const TextChain& chain) {
+  auto base = TextRefCountedBase::allocate(chain.size());
+  auto ptr = base->text_address();
+  for (const auto& segment: chain.segments()) {
+    std::copy(segment.begin(), segment.end(), ptr);
+    ptr += segment.size();
+  }
+  return Text(base);
+}
+
+// Builds a document line by line, flattening it every 100 lines.
+template <typename Flatten>
+bench::Result build(Flatten&& flatten) {
+  return bench::measure(Documents, [&flatten](int64_t) {
+    TextChain chain;
+    for (TSize i = 0; i < Lines; i++) {
+      chain += Line;
+      if (i % 100 == 0) {
+        auto text = flatten(chain);
+        bench::do_not_optimize(text);
+      }
+    }
+  });
+}
+} // namespace
+
+int main() {
+  bench::report("build 20k lines, flatten by copying everything", build(copy_all));
+  bench::report("build 20k lines, TextChain::to_text", build([](const TextChain& chain) { return chain.to_text(); }));
+  return 0;
+}
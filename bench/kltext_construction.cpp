@@ -0,0 +1,34 @@
+#include "bench.hpp"
+#include <kl/text.hpp>
+#include <cstring>
+#include <format>
+
+using namespace kl;
+
+namespace {
+constexpr int64_t Iterations = 2'000'000;
+const char* const Source = "abcdefghijklmnopqrstuvwxyz";
+
+// What every construction cost before the small-string mode: a refcounted heap buffer.
+Text make_buffer_text(const char* ptr, TSize size) {
+  auto base = TextRefCountedBase::allocate(size);
+  std::memcpy(base->text_address(), ptr, size);
+  return Text(base);
+}
+} // namespace
+
+int main() {
+  for (TSize length = 1; length <= 23; length++) {
+    auto small = bench::measure(Iterations, [length](int64_t) {
+      Text t(Source, length);
+      bench::do_not_optimize(t);
+    });
+    auto buffer = bench::measure(Iterations, [length](int64_t) {
+      Text t = make_buffer_text(Source, length);
+      bench::do_not_optimize(t);
+    });
+    bench::report(std::format("Text({} bytes)", length).c_str(), small);
+    bench::report(std::format("Text({} bytes), refcounted buffer", length).c_str(), buffer);
+  }
+  return 0;
+}
@@ -0,0 +1,43 @@
+#include "bench.hpp"
+#include <kl/text.hpp>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+using namespace kl;
+
+namespace {
+constexpr int64_t Lookups = 2'000'000;
+constexpr TSize Keys = 4'096;
+
+struct ViewHash {
+  size_t operator()(const Text& value) const { return std::hash<std::string_view>{}(value.to_view()); }
+};
+
+std::vector<Text> make_paths() {
+  std::vector<Text> paths;
+  for (TSize i = 0; i < Keys; i++) {
+    auto path = "/srv/storage/projects/team-" + std::to_string(i % 37) + "/datasets/2024/measurements/sensor-" +
+                std::to_string(i) + "/aggregated/hourly.parquet";
+    paths.emplace_back(path.data(), static_cast<TSize>(path.size()));
+  }
+  return paths;
+}
+
+template <typename Hash>
+bench::Result lookups(const std::vector<Text>& paths) {
+  std::unordered_set<Text, Hash> set(paths.begin(), paths.end());
+  size_t found = 0;
+  auto result = bench::measure(Lookups, [&](int64_t i) { found += set.count(paths[i % Keys]); });
+  bench::do_not_optimize(found);
+  return result;
+}
+} // namespace
+
+int main() {
+  auto paths = make_paths();
+  bench::report("path lookup, std::hash<std::string_view>", lookups<ViewHash>(paths));
+  bench::report("path lookup, cached Text hash", lookups<std::hash<Text>>(paths));
+  return 0;
+}
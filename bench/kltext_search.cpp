@@ -0,0 +1,54 @@
+#include "bench.hpp"
+#include "text_search.hpp"
+#include <kl/text.hpp>
+#include <format>
+#include <string>
+
+using namespace kl;
+
+namespace {
+constexpr int64_t Iterations = 200'000;
+const std::string_view Whitespace{" \t\n\r"};
+} // namespace
+
+int main() {
+  std::string log;
+  for (int i = 0; i < 8; i++) {
+    log += "    2024-01-01T00:00:00.000Z worker-0042 api[1234]: GET /v1/metrics/cpu.load status=200 took=15ms    ";
+  }
+  auto b = log.data();
+  auto e = b + log.size();
+  for (const auto* kernels:
+       {&text_search::scalar_kernels(), &text_search::sse2_kernels(), &text_search::avx2_kernels()}) {
+    auto find = bench::measure(Iterations, [&](int64_t) {
+      auto p = kernels->find_char(b, e, '\n');
+      bench::do_not_optimize(p);
+    });
+    auto count = bench::measure(Iterations, [&](int64_t) {
+      auto n = kernels->count_char(b, e, ' ');
+      bench::do_not_optimize(n);
+    });
+    auto trim = bench::measure(Iterations, [&](int64_t) {
+      auto p = kernels->find_first_not_of(b, e, Whitespace.data(), 4);
+      auto q = kernels->find_last_not_of(b, e, Whitespace.data(), 4);
+      bench::do_not_optimize(p);
+      bench::do_not_optimize(q);
+    });
+    auto substring = bench::measure(Iterations, [&](int64_t) {
+      auto p = kernels->find_text(b, e, "status=500", 10);
+      bench::do_not_optimize(p);
+    });
+    bench::report(std::format("{}: find_char (miss, {} bytes)", kernels->name, log.size()).c_str(), find);
+    bench::report(std::format("{}: count_char", kernels->name).c_str(), count);
+    bench::report(std::format("{}: trim whitespace", kernels->name).c_str(), trim);
+    bench::report(std::format("{}: find_text (miss)", kernels->name).c_str(), substring);
+  }
+
+  Text text(log.data(), static_cast<TSize>(log.size()));
+  auto split = bench::measure(Iterations / 10, [&](int64_t) {
+    auto fields = text.split_by_char(' ');
+    bench::do_not_optimize(fields);
+  });
+  bench::report("Text::split_by_char(' ')", split);
+  return 0;
+}
@@ -0,0 +1,48 @@
+#include "bench.hpp"
+#include "text_utf8.hpp"
+#include <kl/text.hpp>
+#include <format>
+#include <string>
+
+using namespace kl;
+
+namespace {
+constexpr int64_t Iterations = 2'000;
+} // namespace
+
+int main() {
+  std::string ascii;
+  std::string mixed;
+  while (ascii.size() < 64 * 1024) {
+    ascii += R"({"id": 42, "name": "worker", "tags": ["alpha", "beta"], "load": 0.75}, )";
+    mixed += R"({"name": "René", "city": "K)" "\xC3\xB8" "benhavn\", \"price\": \"12 \xE2\x82\xAC\", "
+             "\"mood\": \"\xF0\x9F\x98\x80\"}, ";
+  }
+  for (const auto* payload: {&ascii, &mixed}) {
+    auto b = payload->data();
+    auto e = b + payload->size();
+    const char* kind = payload == &ascii ? "ascii" : "mixed";
+    for (const auto* kernels:
+         {&text_utf8::scalar_kernels(), &text_utf8::sse2_kernels(), &text_utf8::avx2_kernels()}) {
+      auto validate = bench::measure(Iterations, [&](int64_t) {
+        auto valid = kernels->validate(b, e);
+        bench::do_not_optimize(valid);
+      });
+      auto count = bench::measure(Iterations, [&](int64_t) {
+        auto n = kernels->count_code_points(b, e);
+        bench::do_not_optimize(n);
+      });
+      bench::report(std::format("{}: validate {} KiB {}", kernels->name, payload->size() / 1024, kind).c_str(),
+                    validate);
+      bench::report(std::format("{}: count code points", kernels->name).c_str(), count);
+    }
+  }
+
+  Text text(mixed.data(), static_cast<TSize>(mixed.size()));
+  auto cached = bench::measure(Iterations, [&](int64_t) {
+    auto valid = text.is_valid_utf8();
+    bench::do_not_optimize(valid);
+  });
+  bench::report("Text::is_valid_utf8, cached", cached);
+  return 0;
+}
@@ -0,0 +1,323 @@
+#pragma once
+#include <kl/inttypes.hpp>
+#include <kl/ds/array.hpp>
+#include <kl/ds/cursor.hpp>
+#include <kl/parallel/task_pool.hpp>
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Algorithms over Array, taking their callables as template parameters. Each has a sequential form and a parallel
+// one, selected by passing Parallel{} first, which splits the work over a TaskPool in Cursor ranges. The parallel forms
+// run sequentially on arrays too small to be worth splitting.
+namespace kl {
+
+// Selects the parallel form of an algorithm, running on the given pool.
+struct Parallel {
+  TaskPool& pool = TaskPool::shared();
+};
+
+namespace algorithms {
+// Items per range for the linear algorithms, and the smallest array worth splitting.
+constexpr TSize Grain = 16 * 1024;
+constexpr TSize MinParallelSize = 2 * Grain;
+
+// Number of items of a among the first k items of the stable merge of a (size m) and b (size n).
+template <typename T, typename Less>
+TSize merge_split(const T* a, TSize m, const T* b, TSize n, TSize k, Less& less) {
+  auto low = std::max(TSize{0}, k - n);
+  auto high = std::min(k, m);
+  while (low < high) {
+    auto middle = low + (high - low) / 2;
+    if (less(b[k - middle - 1], a[middle])) {
+      high = middle;
+    } else {
+      low = middle + 1;
+    }
+  }
+  return low;
+}
+
+// Merges the sorted runs of `width` items of source pairwise into destination, in ranges of the output.
+template <typename T, typename Less>
+void merge_runs(TaskPool& pool, T* source, T* destination, TSize size, TSize width, Less& less) {
+  pool.for_ranges(size, Grain * 4, [&](Cursor begin, Cursor end) {
+    for (auto position = begin.position(); position < end.position();) {
+      auto pair_start = position - static_cast<TSize>(position % (int64_t{width} * 2));
+      auto middle = size - pair_start > width ? pair_start + width : size;
+      auto pair_end = size - middle > width ? middle + width : size;
+      auto first = position - pair_start;
+      auto last = std::min(end.position(), pair_end) - pair_start;
+      auto a = source + pair_start;
+      auto b = source + middle;
+      auto a_first = merge_split(a, middle - pair_start, b, pair_end - middle, first, less);
+      auto a_last = merge_split(a, middle - pair_start, b, pair_end - middle, last, less);
+      std::merge(std::make_move_iterator(a + a_first), std::make_move_iterator(a + a_last),
+                 std::make_move_iterator(b + first - a_first), std::make_move_iterator(b + last - a_last),
+                 destination + position, less);
+      position = pair_start + last;
+    }
+  });
+}
+
+// Runs build(begin, end, built) over ranges of size items, build constructing outputs of type T for its range and
+// counting them in built. If a range throws, destroy(range, built) runs for each range that constructed any outputs,
+// with its count, before the exception is rethrown: no output is left constructed, for the caller to release raw.
+template <typename T, typename Build, typename Destroy>
+void build_ranges(TaskPool& pool, TSize size, TSize grain, Build&& build, Destroy&& destroy) {
+  if constexpr (std::is_trivially_destructible_v<T>) {
+    pool.for_ranges(size, grain, [&](Cursor begin, Cursor end) {
+      TSize built = 0;
+      build(begin, end, built);
+    });
+  } else {
+    Array<TSize> counts(TagBuild{}, static_cast<TSize>((int64_t{size} + grain - 1) / grain), 0);
+    try {
+      pool.for_ranges(size, grain,
+                      [&](Cursor begin, Cursor end) { build(begin, end, counts[begin.position() / grain]); });
+    } catch (...) {
+      for (TSize range = 0; range < counts.size(); range++) {
+        if (counts[range] > 0) {
+          destroy(range, counts[range]);
+        }
+      }
+      throw;
+    }
+  }
+}
+
+// Tests each item with pred, remembering the answers in flags, and returns the offset of the first match of each range
+// among all the matches; the total is added at the end.
+template <typename T, typename R, typename Pred>
+Array<TSize> match_offsets(TaskPool& pool, const Array<T, R>& items, Pred& pred, Array<bool>& flags) {
+  Array<TSize> counts(TagBuild{}, static_cast<TSize>((int64_t{items.size()} + Grain - 1) / Grain), 0);
+  pool.for_ranges(items.size(), Grain, [&](Cursor begin, Cursor end) {
+    TSize count = 0;
+    for (auto i = begin.position(); i < end.position(); i++) {
+      flags.data()[i] = static_cast<bool>(std::invoke(pred, items.data()[i]));
+      count += flags.data()[i];
+    }
+    counts[begin.position() / Grain] = count;
+  });
+  TSize total = 0;
+  for (auto& count: counts) {
+    total += std::exchange(count, total);
+  }
+  counts.push_back(total);
+  return counts;
+}
+} // namespace algorithms
+
+// Sorts the items, in no particular order among equal ones.
+template <typename T, typename R, typename Less = std::less<>>
+void sort(Array<T, R>& items, Less less = {}) {
+  std::sort(items.begin(), items.end(), less);
+}
+
+// Sorts ranges of the items in parallel, then merges them pairwise; each merge is itself split into ranges of its
+// output. Uses a buffer of the size of the array.
+template <typename T, typename R, typename Less = std::less<>>
+void sort(Parallel parallel, Array<T, R>& items, Less less = {}) {
+  auto size = items.size();
+  auto& pool = parallel.pool;
+  if (size < algorithms::MinParallelSize || pool.concurrency() == 1) {
+    sort(items, less);
+    return;
+  }
+  auto runs = static_cast<TSize>(std::bit_ceil(static_cast<uint32_t>(pool.concurrency() * 4)));
+  auto width = static_cast<TSize>((int64_t{size} + runs - 1) / runs);
+  Array<T> buffer(TagReserve{}, size);
+  algorithms::build_ranges<T>(
+      pool, size, width,
+      [&](Cursor begin, Cursor end, TSize& built) {
+        std::sort(items.data() + begin.position(), items.data() + end.position(), less);
+        std::uninitialized_move(items.data() + begin.position(), items.data() + end.position(),
+                                buffer.data() + begin.position());
+        built = end.position() - begin.position();
+      },
+      [&](TSize range, TSize built) { std::destroy_n(buffer.data() + range * width, built); });
+  buffer.assume_constructed(size);
+  T* source = buffer.data();
+  T* destination = items.data();
+  for (; width < size; width = width > size / 2 ? size : width * 2) {
+    algorithms::merge_runs(pool, source, destination, size, width, less);
+    std::swap(source, destination);
+  }
+  if (source != items.data()) {
+    pool.for_ranges(size, algorithms::Grain, [&](Cursor begin, Cursor end) {
+      std::move(source + begin.position(), source + end.position(), items.data() + begin.position());
+    });
+  }
+}
+
+// The results of fn for each item, in order.
+template <typename T, typename R, typename Fn>
+auto transform(const Array<T, R>& items, Fn&& fn) {
+  Array<std::remove_cvref_t<std::invoke_result_t<Fn&, const T&>>> result(TagReserve{}, items.size());
+  for (const auto& item: items) {
+    result.push_back(std::invoke(fn, item));
+  }
+  return result;
+}
+
+template <typename T, typename R, typename Fn>
+auto transform(Parallel parallel, const Array<T, R>& items, Fn&& fn) {
+  using U = std::remove_cvref_t<std::invoke_result_t<Fn&, const T&>>;
+  if (items.size() < algorithms::MinParallelSize || parallel.pool.concurrency() == 1) {
+    return transform(items, fn);
+  }
+  Array<U> result(TagReserve{}, items.size());
+  algorithms::build_ranges<U>(
+      parallel.pool, items.size(), algorithms::Grain,
+      [&](Cursor begin, Cursor end, TSize& built) {
+        for (auto i = begin.position(); i < end.position(); i++, built++) {
+          new (result.data() + i) U(std::invoke(fn, items.data()[i]));
+        }
+      },
+      [&](TSize range, TSize built) { std::destroy_n(result.data() + range * algorithms::Grain, built); });
+  result.assume_constructed(items.size());
+  return result;
+}
+
+// Folds the items into init with op, from the first to the last.
+template <typename T, typename R, typename V, typename Op>
+V reduce(const Array<T, R>& items, V init, Op&& op) {
+  for (const auto& item: items) {
+    init = std::invoke(op, std::move(init), item);
+  }
+  return init;
+}
+
+// The same; combine is only used by the parallel form, and accepted here so that both forms take the same calls.
+template <typename T, typename R, typename V, typename Op, typename Combine>
+V reduce(const Array<T, R>& items, V init, Op&& op, Combine&&) {
+  return reduce(items, std::move(init), op);
+}
+
+// Folds each range of items with op, starting from V{}, then folds the results into init in order with combine. V{}
+// must be an identity of combine, and combine(a, op(b, item)) must equal op(combine(a, b), item), as with counting
+// items in op and adding the counts in combine.
+template <typename T, typename R, typename V, typename Op, typename Combine>
+V reduce(Parallel parallel, const Array<T, R>& items, V init, Op&& op, Combine&& combine) {
+  auto size = items.size();
+  if (size < algorithms::MinParallelSize || parallel.pool.concurrency() == 1) {
+    return reduce(items, std::move(init), op);
+  }
+  auto ranges = static_cast<TSize>((int64_t{size} + algorithms::Grain - 1) / algorithms::Grain);
+  Array<V> partials(TagReserve{}, ranges);
+  algorithms::build_ranges<V>(
+      parallel.pool, size, algorithms::Grain,
+      [&](Cursor begin, Cursor end, TSize& built) {
+        V value{};
+        for (auto i = begin.position(); i < end.position(); i++) {
+          value = std::invoke(op, std::move(value), items.data()[i]);
+        }
+        new (partials.data() + begin.position() / algorithms::Grain) V(std::move(value));
+        built = 1;
+      },
+      [&](TSize range, TSize) { std::destroy_at(partials.data() + range); });
+  partials.assume_constructed(ranges);
+  for (auto& partial: partials) {
+    init = std::invoke(combine, std::move(init), std::move(partial));
+  }
+  return init;
+}
+
+// The same, with op also combining the results of the ranges: it must be associative, take both (V, T) and (V, V),
+// and have V{} as its identity.
+template <typename T, typename R, typename V, typename Op>
+V reduce(Parallel parallel, const Array<T, R>& items, V init, Op&& op) {
+  return reduce(parallel, items, std::move(init), op, op);
+}
+
+// Copies of the items satisfying pred, in order.
+template <typename T, typename R, typename Pred>
+Array<T> filter(const Array<T, R>& items, Pred&& pred) {
+  Array<T> result;
+  for (const auto& item: items) {
+    if (std::invoke(pred, item)) {
+      result.push_back(item);
+    }
+  }
+  return result;
+}
+
+// Tests the items in parallel ranges, then each range copies its matches to the offset its preceding ranges leave.
+template <typename T, typename R, typename Pred>
+Array<T> filter(Parallel parallel, const Array<T, R>& items, Pred&& pred) {
+  if (items.size() < algorithms::MinParallelSize || parallel.pool.concurrency() == 1) {
+    return filter(items, pred);
+  }
+  Array<bool> flags(TagNoInit{}, items.size());
+  auto offsets = algorithms::match_offsets(parallel.pool, items, pred, flags);
+  Array<T> result(TagReserve{}, offsets[-1]);
+  algorithms::build_ranges<T>(
+      parallel.pool, items.size(), algorithms::Grain,
+      [&](Cursor begin, Cursor end, TSize& built) {
+        auto output = result.data() + offsets[begin.position() / algorithms::Grain];
+        for (auto i = begin.position(); i < end.position(); i++) {
+          if (flags.data()[i]) {
+            new (output + built) T(items.data()[i]);
+            built++;
+          }
+        }
+      },
+      [&](TSize range, TSize built) { std::destroy_n(result.data() + offsets[range], built); });
+  result.assume_constructed(offsets[-1]);
+  return result;
+}
+
+// Moves the items satisfying pred before the others, keeping the order within both groups. Returns the cursor of the
+// first item of the second group.
+template <typename T, typename R, typename Pred>
+Cursor partition(Array<T, R>& items, Pred&& pred) {
+  auto split =
+      std::stable_partition(items.begin(), items.end(), [&](const T& item) { return std::invoke(pred, item); });
+  return Cursor(static_cast<TSize>(split - items.begin()));
+}
+
+// Like the parallel filter, moving each group to its place in a buffer, and the buffer back over the items.
+template <typename T, typename R, typename Pred>
+Cursor partition(Parallel parallel, Array<T, R>& items, Pred&& pred) {
+  auto size = items.size();
+  auto& pool = parallel.pool;
+  if (size < algorithms::MinParallelSize || pool.concurrency() == 1) {
+    return partition(items, pred);
+  }
+  Array<bool> flags(TagNoInit{}, size);
+  auto offsets = algorithms::match_offsets(pool, items, pred, flags);
+  auto matching = offsets[-1];
+  Array<T> buffer(TagReserve{}, size);
+  // the places of the items of a range in the buffer, in order
+  auto for_places = [&](TSize begin, TSize end, auto&& fn) {
+    auto before = offsets[begin / algorithms::Grain];
+    auto selected = buffer.data() + before;
+    auto rest = buffer.data() + matching + (begin - before);
+    for (auto i = begin; i < end; i++) {
+      fn(i, flags.data()[i] ? selected++ : rest++);
+    }
+  };
+  algorithms::build_ranges<T>(
+      pool, size, algorithms::Grain,
+      [&](Cursor begin, Cursor end, TSize& built) {
+        for_places(begin.position(), end.position(), [&](TSize i, T* place) {
+          new (place) T(std::move(items.data()[i]));
+          built++;
+        });
+      },
+      [&](TSize range, TSize built) {
+        auto begin = range * algorithms::Grain;
+        for_places(begin, begin + built, [](TSize, T* place) { std::destroy_at(place); });
+      });
+  buffer.assume_constructed(size);
+  pool.for_ranges(size, algorithms::Grain, [&](Cursor begin, Cursor end) {
+    std::move(buffer.data() + begin.position(), buffer.data() + end.position(), items.data() + begin.position());
+  });
+  return Cursor(matching);
+}
+
+} // namespace kl
@@ -2,6 +2,12 @@
 #include <kl/inttypes.hpp>
 #include <kl/ds/tags.hpp>
 #include <kl/except.hpp>
+#include <kl/memory/allocation_stats.hpp>
+#include <kl/memory/blocks.hpp>
+#include <kl/memory/relocation.hpp>
+#include <kl/memory/resource.hpp>
+#include <cstddef>
+#include <cstring>
 #include <utility>
 #include <initializer_list>
 
@@ -9,8 +15,20 @@
 
 namespace kl {
 
-template <typename T>
+// The capacity kl arrays grow to when they need room for `required` items: at least double, and at least 8 more.
+constexpr TSize grown_capacity(TSize reserved, TSize required) {
+  return reserved + std::max(reserved, std::max(required - reserved, 8));
+}
+
+/**
+ * @brief Growable list of items, with storage from a memory resource (see resource.hpp).
+ *
+ * The resource is copied and moved along with the items, so that the storage always goes back where it came from.
+ * The default one takes no room in the Array.
+ */
+template <typename T, MemoryResource R = DefaultResource>
 class Array {
+  [[no_unique_address]] R m_resource;
   T* m_data;
   TSize m_size;
   TSize m_reserved;
@@ -29,11 +47,31 @@ class Array {
     return index;
   }
 
+  // Items that can be relocated by copying their bytes grow through the resource, when it can grow blocks, so that
+  // growth can extend or remap the storage instead of copying it (see blocks.hpp).
+  static constexpr bool InBlocks = is_trivially_relocatable<T> && GrowableMemoryResource<R>;
+
+  constexpr T* allocate_items(TSize count) {
+    if (count <= 0) {
+      return nullptr;
+    }
+    auto items = static_cast<T*>(m_resource.allocate(count * sizeof(T)));
+    track_allocation(AllocationCategory::Array, count * sizeof(T));
+    return items;
+  }
+
+  constexpr void release_storage() {
+    if (m_data != nullptr) {
+      m_resource.release(m_data, m_reserved * sizeof(T));
+      track_release(AllocationCategory::Array, m_reserved * sizeof(T));
+    }
+  }
+
   constexpr void release_data() {
     for (TSize i = 0; i < m_size; i++) {
       m_data[i].~T();
     }
-    ::operator delete(m_data);
+    release_storage();
   }
 
   constexpr void allocate_space_for_next(int count = 1) {
@@ -44,9 +82,7 @@ class Array {
       throw Exception("Out of range");
     }
     if (m_size + count > m_reserved) {
-      auto required = std::max((m_size + count) - m_reserved, 8);
-      auto new_items_size = m_reserved + std::max(m_reserved, required);
-      reserve(new_items_size);
+      reserve(grown_capacity(m_reserved, m_size + count));
     }
   }
 
@@ -54,17 +90,19 @@ public:
   constexpr Array() : m_data(nullptr), m_size(0), m_reserved(0) {}
   template <typename... Args>
   constexpr Array(TagBuild, TSize size, Args&&... args)
-      : m_data(static_cast<T*>(::operator new(size * sizeof(T)))), m_size(size), m_reserved(size) {
+      : m_data(allocate_items(size)), m_size(size), m_reserved(size) {
     for (TSize i = 0; i < m_size; i++) {
       new (m_data + i) T(std::forward<Args>(args)...);
     }
   }
-  constexpr Array(TagNoInit, TSize size)
-      : m_data(static_cast<T*>(::operator new(size * sizeof(T)))), m_size(size), m_reserved(size) {}
-  constexpr Array(TagReserve, TSize size)
-      : m_data(static_cast<T*>(::operator new(size * sizeof(T)))), m_size(0), m_reserved(size) {}
+  constexpr Array(TagNoInit, TSize size, R resource = {})
+      : m_resource(resource), m_data(allocate_items(size)), m_size(size), m_reserved(size) {}
+  constexpr Array(TagReserve, TSize size, R resource = {})
+      : m_resource(resource), m_data(allocate_items(size)), m_size(0), m_reserved(size) {}
+  constexpr explicit Array(R resource) : m_resource(resource), m_data(nullptr), m_size(0), m_reserved(0) {}
 
-  constexpr Array(std::initializer_list<T> list) : Array(TagNoInit{}, list.size()) {
+  constexpr Array(std::initializer_list<T> list, R resource = {})
+      : Array(TagNoInit{}, static_cast<TSize>(list.size()), resource) {
     TSize i = 0;
     for (const auto& item: list) {
       new (m_data + i) T(item);
@@ -72,6 +110,33 @@ public:
     }
   }
 
+  constexpr Array(const Array& other) : Array(TagReserve{}, other.m_size, other.m_resource) {
+    for (TSize i = 0; i < other.m_size; i++) {
+      new (m_data + i) T(other.m_data[i]);
+      m_size++;
+    }
+  }
+  constexpr Array(Array&& other) noexcept
+      : m_resource(other.m_resource), m_data(std::exchange(other.m_data, nullptr)),
+        m_size(std::exchange(other.m_size, 0)), m_reserved(std::exchange(other.m_reserved, 0)) {}
+
+  constexpr Array& operator=(const Array& other) {
+    if (this != &other) {
+      *this = Array(other);
+    }
+    return *this;
+  }
+  constexpr Array& operator=(Array&& other) noexcept {
+    if (this != &other) {
+      release_data();
+      m_resource = other.m_resource;
+      m_data = std::exchange(other.m_data, nullptr);
+      m_size = std::exchange(other.m_size, 0);
+      m_reserved = std::exchange(other.m_reserved, 0);
+    }
+    return *this;
+  }
+
   constexpr ~Array() {
     release_data();
     m_data = nullptr;
@@ -86,17 +151,98 @@ public:
     return m_data[m_size - 1];
   }
 
+  constexpr T& push_back(T&& value) {
+    allocate_space_for_next();
+    new (m_data + m_size) T(std::move(value));
+    ++m_size;
+    return m_data[m_size - 1];
+  }
+
   template <typename... Args>
   constexpr T& emplace_back(Args&&... args) {
     allocate_space_for_next();
-    new (m_data + m_size) T(std::forward(args)...);
+    new (m_data + m_size) T(std::forward<Args>(args)...);
     ++m_size;
     return m_data[m_size - 1];
   }
 
+  // Inserts the value before the item at index; index can also be size(), appending the value.
+  constexpr T& insert(TSize index, T value) {
+    if (index != m_size) {
+      strict_index(index);
+    }
+    allocate_space_for_next();
+    if constexpr (is_trivially_relocatable<T>) {
+      if !consteval {
+        std::memmove(static_cast<void*>(m_data + index + 1), static_cast<const void*>(m_data + index),
+                     (m_size - index) * sizeof(T));
+        new (m_data + index) T(std::move(value));
+        ++m_size;
+        return m_data[index];
+      }
+    }
+    if (index == m_size) {
+      new (m_data + m_size) T(std::move(value));
+    } else {
+      new (m_data + m_size) T(std::move(m_data[m_size - 1]));
+      for (TSize i = m_size - 1; i > index; i--) {
+        m_data[i] = std::move(m_data[i - 1]);
+      }
+      m_data[index] = std::move(value);
+    }
+    ++m_size;
+    return m_data[index];
+  }
+
+  constexpr void remove_at(TSize index) {
+    index = flex_index(index);
+    if constexpr (is_trivially_relocatable<T>) {
+      if !consteval {
+        m_data[index].~T();
+        std::memmove(static_cast<void*>(m_data + index), static_cast<const void*>(m_data + index + 1),
+                     (m_size - index - 1) * sizeof(T));
+        --m_size;
+        return;
+      }
+    }
+    for (TSize i = index + 1; i < m_size; i++) {
+      m_data[i - 1] = std::move(m_data[i]);
+    }
+    --m_size;
+    m_data[m_size].~T();
+  }
+
+  constexpr void clear() {
+    for (TSize i = 0; i < m_size; i++) {
+      m_data[i].~T();
+    }
+    m_size = 0;
+  }
+
   constexpr void reserve(TSize size) {
     if (size > m_reserved) {
-      auto new_data = static_cast<T*>(::operator new(size * sizeof(T)));
+      if constexpr (InBlocks) {
+        if (m_data != nullptr) {
+          // the items change address, if at all, without being moved and destroyed one by one
+          m_data = static_cast<T*>(m_resource.grow(m_data, m_reserved * sizeof(T), size * sizeof(T)));
+          track_release(AllocationCategory::Array, m_reserved * sizeof(T));
+          track_allocation(AllocationCategory::Array, size * sizeof(T));
+          m_reserved = size;
+          return;
+        }
+      }
+      auto new_data = allocate_items(size);
+      if constexpr (is_trivially_relocatable<T>) {
+        if !consteval {
+          if (m_size > 0) {
+            std::memcpy(static_cast<void*>(new_data), static_cast<const void*>(m_data), m_size * sizeof(T));
+          }
+          release_storage();
+          m_data = new_data;
+          m_reserved = size;
+          return;
+        }
+      }
       for (TSize i = 0; i < m_size; i++) {
         new (new_data + i) T(std::move(m_data[i]));
       }
@@ -105,6 +251,14 @@ public:
       m_reserved = size;
     }
   }
+  // Makes the first size reserved items part of the array, once they are constructed in place through data(), like
+  // storage reserved with TagReserve and filled out of order.
+  constexpr void assume_constructed(TSize size) {
+    if (size < m_size || size > m_reserved) [[unlikely]] {
+      throw Exception("Out of range: {} out of {}", size, m_reserved);
+    }
+    m_size = size;
+  }
 
   constexpr T* begin() const { return m_data; }
   constexpr T* end() const { return m_data + m_size; }
@@ -121,6 +275,10 @@ public:
   constexpr TSize size() const { return m_size; }
   constexpr TSize reserved() const { return m_reserved; }
   constexpr T* data() const { return m_data; }
+  constexpr const R& resource() const { return m_resource; }
 };
 
+template <typename T, typename R>
+struct TriviallyRelocatable<Array<T, R>> : std::bool_constant<is_trivially_relocatable<R>> {};
+
 } // namespace kl
\ No newline at end of file
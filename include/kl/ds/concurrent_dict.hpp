@@ -0,0 +1,181 @@
+#pragma once
+
+#include "dict.hpp"
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+
+namespace kl {
+
+/**
+ * @brief Dict that can be shared between threads.
+ *
+ * The items are spread by hash over independent shards, each a Dict with its own reader/writer lock, so threads
+ * working on different keys seldom wait for each other. Each shard takes a cache line of its own, so that taking one
+ * lock does not slow down the others. By default there are four shards per hardware thread.
+ *
+ * Values are returned by copy, since a reference would outlive the lock. The callbacks of update() and for_each() run
+ * under the lock of their shard, and must not call back into the same ConcurrentDict.
+ */
+template <typename Key, typename Value>
+class ConcurrentDict {
+  struct alignas(64) Shard {
+    mutable std::shared_mutex lock;
+    Dict<Key, Value> items;
+  };
+
+  Shard* m_shards;
+  uint64_t m_shard_mask;
+
+  template <typename K>
+  Shard& shard_for(const K& key) const {
+    // the low bits of the hash place the key inside its shard's table, the shard comes from the high ones
+    return m_shards[(Dict<Key, Value>::hash(key) >> 40) & m_shard_mask];
+  }
+
+  template <typename K>
+  static decltype(auto) lookup_key(K&& key) {
+    if constexpr (DictLookupKey<std::remove_cvref_t<K>, Key>) {
+      return std::forward<K>(key);
+    } else {
+      return Key(std::forward<K>(key));
+    }
+  }
+
+public:
+  static TSize default_shard_count() {
+    return static_cast<TSize>(std::bit_ceil(std::max(std::thread::hardware_concurrency(), 1u) * 4));
+  }
+
+  // The shard count is rounded up to a power of two.
+  explicit ConcurrentDict(TSize shard_count = default_shard_count()) {
+    if (shard_count < 1 || shard_count > (1 << 24)) {
+      throw Exception("Invalid shard count: {}", shard_count);
+    }
+    auto count = std::bit_ceil(static_cast<uint32_t>(shard_count));
+    m_shards = static_cast<Shard*>(::operator new(count * sizeof(Shard), std::align_val_t{alignof(Shard)}));
+    for (uint32_t i = 0; i < count; i++) {
+      new (m_shards + i) Shard();
+    }
+    m_shard_mask = count - 1;
+  }
+  ConcurrentDict(const ConcurrentDict&) = delete;
+  ConcurrentDict& operator=(const ConcurrentDict&) = delete;
+  ~ConcurrentDict() {
+    for (uint64_t i = 0; i <= m_shard_mask; i++) {
+      m_shards[i].~Shard();
+    }
+    ::operator delete(m_shards, std::align_val_t{alignof(Shard)});
+  }
+
+  TSize shard_count() const { return static_cast<TSize>(m_shard_mask + 1); }
+
+  // Number of items; with concurrent writers, it is only a snapshot of each shard in turn.
+  TSize size() const {
+    TSize size = 0;
+    for (uint64_t i = 0; i <= m_shard_mask; i++) {
+      std::shared_lock guard(m_shards[i].lock);
+      size += m_shards[i].items.size();
+    }
+    return size;
+  }
+
+  void clear() {
+    for (uint64_t i = 0; i <= m_shard_mask; i++) {
+      std::unique_lock guard(m_shards[i].lock);
+      m_shards[i].items.clear();
+    }
+  }
+
+  template <DictLookupKey<Key> K>
+  bool has(const K& key) const {
+    auto& shard = shard_for(key);
+    std::shared_lock guard(shard.lock);
+    return shard.items.has(key);
+  }
+
+  template <DictLookupKey<Key> K>
+  std::optional<Value> get_opt(const K& key) const {
+    auto& shard = shard_for(key);
+    std::shared_lock guard(shard.lock);
+    return shard.items.get_opt(key);
+  }
+
+  template <DictLookupKey<Key> K>
+  Value get(const K& key, const Value& default_value = Value()) const {
+    auto& shard = shard_for(key);
+    std::shared_lock guard(shard.lock);
+    return shard.items.get(key, default_value);
+  }
+
+  // Inserts the value, or replaces the value already stored for the key.
+  template <typename K, typename V>
+  void add(K&& key, V&& value) {
+    decltype(auto) lookup = lookup_key(std::forward<K>(key));
+    auto& shard = shard_for(lookup);
+    std::unique_lock guard(shard.lock);
+    shard.items.add(std::forward<decltype(lookup)>(lookup), std::forward<V>(value));
+  }
+
+  // The value stored for the key; when there is none, stores and returns the one built by make(). Only the writer
+  // that inserts calls make(), under the shard's lock.
+  template <typename K, std::invocable Make>
+  Value get_or_insert(K&& key, Make&& make) {
+    decltype(auto) lookup = lookup_key(std::forward<K>(key));
+    auto& shard = shard_for(lookup);
+    {
+      std::shared_lock guard(shard.lock);
+      if (auto value = shard.items.find(lookup); value != nullptr) {
+        return *value;
+      }
+    }
+    std::unique_lock guard(shard.lock);
+    if (auto value = shard.items.find(lookup); value != nullptr) {
+      return *value;
+    }
+    Value value = std::forward<Make>(make)();
+    shard.items.add(std::forward<decltype(lookup)>(lookup), value);
+    return value;
+  }
+
+  // Calls update(Value&) on the value stored for the key, under the shard's lock; returns whether there was one.
+  template <DictLookupKey<Key> K, typename Update>
+  bool update(const K& key, Update&& update) {
+    auto& shard = shard_for(key);
+    std::unique_lock guard(shard.lock);
+    auto value = shard.items.find(key);
+    if (value == nullptr) {
+      return false;
+    }
+    std::forward<Update>(update)(*value);
+    return true;
+  }
+
+  // Removes the key, if present; returns whether it was.
+  template <DictLookupKey<Key> K>
+  bool remove(const K& key) {
+    auto& shard = shard_for(key);
+    std::unique_lock guard(shard.lock);
+    return shard.items.remove(key);
+  }
+
+  // Calls fn(const Key&, const Value&) for every item, holding the read lock of one shard at a time. Writers can
+  // change the shards not yet visited, so the items seen are not a snapshot of the whole dict.
+  template <typename Fn>
+  void for_each(Fn&& fn) const {
+    for (uint64_t i = 0; i <= m_shard_mask; i++) {
+      std::shared_lock guard(m_shards[i].lock);
+      for (const auto& item: m_shards[i].items) {
+        fn(item.first, item.second);
+      }
+    }
+  }
+};
+
+} // namespace kl
@@ -2,11 +2,435 @@
 
 #include "pair.hpp"
 #include "array.hpp"
+#include <kl/hash.hpp>
+#include <kl/except.hpp>
+#include <bit>
+#include <concepts>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <new>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace kl {
+
+// Keys like kl::Text, which expose their content as a view and hash it with hash_bytes(), can be looked up by
+// anything that converts to std::string_view, without building a key first.
+template <typename K, typename Key>
+concept DictLookupKey =
+    std::same_as<K, Key> || (requires(const Key& key) {
+      { key.to_view() } -> std::convertible_to<std::string_view>;
+      { key.hash() } -> std::convertible_to<uint64_t>;
+    } && std::convertible_to<const K&, std::string_view>);
+
+// The key stored for a lookup key: lookup keys the key type doesn't convert from, like std::string_view for kl::Text,
+// give it a copy of their bytes.
+template <typename Key, typename K>
+Key make_dict_key(K&& key) {
+  if constexpr (std::constructible_from<Key, K&&>) {
+    return Key(std::forward<K>(key));
+  } else {
+    std::string_view view = key;
+    return Key(view.data(), static_cast<TSize>(view.size()));
+  }
+}
+
+// Control bytes of a Dict slot: a full slot holds the low 7 bits of its key's hash, the other states are negative.
+struct DictControl {
+  static constexpr int8_t Empty = -128;
+  static constexpr int8_t Deleted = -2;
+
+  // A group of consecutive control bytes, matched all at once. Bit i of a mask stands for the i-th slot of the group.
+  struct Group {
+#ifdef __SSE2__
+    static constexpr TSize Width = 16;
+    __m128i ctrl;
+
+    explicit Group(const int8_t* p) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+    uint32_t match(int8_t h2) const {
+      return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)));
+    }
+    uint32_t match_empty() const { return match(Empty); }
+    // empty or deleted: the only states with the high bit set
+    uint32_t match_free() const { return static_cast<uint32_t>(_mm_movemask_epi8(ctrl)); }
+#else
+    static constexpr TSize Width = 8;
+    const int8_t* ctrl;
+
+    explicit Group(const int8_t* p) : ctrl(p) {}
+    uint32_t match(int8_t h2) const {
+      uint32_t mask = 0;
+      for (TSize i = 0; i < Width; i++) {
+        mask |= static_cast<uint32_t>(ctrl[i] == h2) << i;
+      }
+      return mask;
+    }
+    uint32_t match_empty() const { return match(Empty); }
+    uint32_t match_free() const {
+      uint32_t mask = 0;
+      for (TSize i = 0; i < Width; i++) {
+        mask |= static_cast<uint32_t>(ctrl[i] < 0) << i;
+      }
+      return mask;
+    }
+#endif
+  };
+};
+
+/**
+ * @brief Hash map with open addressing, in the style of SwissTable.
+ *
+ * Every slot has a control byte holding 7 bits of its key's hash. A lookup walks the table one group of control
+ * bytes at a time, comparing the whole group against those 7 bits with a single vector compare, and only compares
+ * the keys of the (rare) slots that match. The probe stops at the first group with an empty slot. The control bytes
+ * of the first group are mirrored after the last one, so a group can be loaded at any position without wrapping.
+ * The table grows (doubling) at 7/8 occupancy; erased slots are marked deleted and reclaimed on the next rehash.
+ *
+ * Pointers and references to values are invalidated by insertions that grow the table. Keys must not be modified
+ * through iteration.
+ */
 template <typename Key, typename Value>
 class Dict {
+  using Slot = Pair<Key, Value>;
+  using Group = DictControl::Group;
+  static constexpr TSize MinCapacity = Group::Width;
+
+  Slot* m_slots = nullptr;
+  int8_t* m_ctrl = nullptr;
+  TSize m_capacity = 0;
+  TSize m_size = 0;
+  TSize m_deleted = 0;
+
+  template <typename K>
+  static uint64_t hash_of(const K& key) {
+    if constexpr (!std::same_as<K, Key>) {
+      std::string_view view(key);
+      return hash_bytes(view.data(), view.size());
+    } else if constexpr (requires { key.hash(); }) {
+      return key.hash();
+    } else {
+      // spread hashes such as the identity hash of integers over all the bits
+      return wyhash::mix(std::hash<Key>{}(key) ^ wyhash::Secret[0], wyhash::Secret[1]);
+    }
+  }
+  template <typename K>
+  static bool equals(const Key& key, const K& lookup) {
+    if constexpr (std::same_as<K, Key>) {
+      return key == lookup;
+    } else {
+      return key.to_view() == std::string_view(lookup);
+    }
+  }
+  static int8_t h2(uint64_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+  static TSize h1(uint64_t hash) { return static_cast<TSize>(hash >> 7); }
+
+  static TSize max_load(TSize capacity) { return capacity - capacity / 8; }
+
+  void set_ctrl(TSize index, int8_t value) {
+    m_ctrl[index] = value;
+    if (index < Group::Width) {
+      m_ctrl[m_capacity + index] = value;
+    }
+  }
+
+  template <typename K>
+  TSize find_index(const K& key) const {
+    if (m_size == 0) {
+      return -1;
+    }
+    auto hash = hash_of(key);
+    auto mask = m_capacity - 1;
+    auto position = h1(hash) & mask;
+    for (TSize step = Group::Width;; step += Group::Width) {
+      Group group(m_ctrl + position);
+      for (auto matches = group.match(h2(hash)); matches != 0; matches &= matches - 1) {
+        auto index = (position + std::countr_zero(matches)) & mask;
+        if (equals(m_slots[index].first, key)) [[likely]] {
+          return index;
+        }
+      }
+      if (group.match_empty() != 0) {
+        return -1;
+      }
+      position = (position + step) & mask;
+    }
+  }
+
+  // First free slot on the probe sequence of the hash; the table is never full.
+  TSize find_free(uint64_t hash) const {
+    auto mask = m_capacity - 1;
+    auto position = h1(hash) & mask;
+    for (TSize step = Group::Width;; step += Group::Width) {
+      auto free = Group(m_ctrl + position).match_free();
+      if (free != 0) {
+        return (position + std::countr_zero(free)) & mask;
+      }
+      position = (position + step) & mask;
+    }
+  }
+
+  void allocate(TSize capacity) {
+    auto memory = static_cast<char*>(::operator new(capacity * sizeof(Slot) + capacity + Group::Width));
+    m_slots = reinterpret_cast<Slot*>(memory);
+    m_ctrl = reinterpret_cast<int8_t*>(memory + capacity * sizeof(Slot));
+    std::fill(m_ctrl, m_ctrl + capacity + Group::Width, DictControl::Empty);
+    m_capacity = capacity;
+    m_deleted = 0;
+  }
+
+  void release() {
+    for (TSize i = 0; i < m_capacity; i++) {
+      if (m_ctrl[i] >= 0) {
+        m_slots[i].~Slot();
+      }
+    }
+    ::operator delete(m_slots);
+    m_slots = nullptr;
+    m_ctrl = nullptr;
+    m_capacity = 0;
+    m_size = 0;
+    m_deleted = 0;
+  }
+
+  void rehash(TSize capacity) {
+    auto old_slots = m_slots;
+    auto old_ctrl = m_ctrl;
+    auto old_capacity = m_capacity;
+    allocate(capacity);
+    for (TSize i = 0; i < old_capacity; i++) {
+      if (old_ctrl[i] >= 0) {
+        auto hash = hash_of(old_slots[i].first);
+        auto index = find_free(hash);
+        set_ctrl(index, h2(hash));
+        if constexpr (is_trivially_relocatable<Slot>) {
+          std::memcpy(static_cast<void*>(m_slots + index), static_cast<const void*>(old_slots + i), sizeof(Slot));
+        } else {
+          new (m_slots + index) Slot(std::move(old_slots[i]));
+          old_slots[i].~Slot();
+        }
+      }
+    }
+    ::operator delete(old_slots);
+  }
+
+  // Makes room for one more insertion: grows the table, or only drops the deleted slots when they take most of it.
+  void prepare_insert() {
+    if (m_capacity == 0) {
+      allocate(MinCapacity);
+    } else if (m_size + m_deleted + 1 > max_load(m_capacity)) {
+      if (TSIZE_MAX / 2 < m_capacity) [[unlikely]] {
+        throw Exception("Dict too large: {}", m_size);
+      }
+      rehash(m_size + 1 <= max_load(m_capacity) / 2 ? m_capacity : m_capacity * 2);
+    }
+  }
+
+  template <typename K, typename V>
+  void insert_new(K&& key, V&& value) {
+    prepare_insert();
+    auto hash = hash_of(key);
+    auto index = find_free(hash);
+    if (m_ctrl[index] == DictControl::Deleted) {
+      m_deleted--;
+    }
+    new (m_slots + index) Slot{make_dict_key<Key>(std::forward<K>(key)), Value(std::forward<V>(value))};
+    set_ctrl(index, h2(hash));
+    m_size++;
+  }
+
 public:
+  template <bool Const>
+  class Iterator {
+    using DictType = std::conditional_t<Const, const Dict, Dict>;
+    DictType* m_dict;
+    TSize m_index;
+
+    void skip_free() {
+      while (m_index < m_dict->m_capacity && m_dict->m_ctrl[m_index] < 0) {
+        m_index++;
+      }
+    }
+
+  public:
+    Iterator(DictType* dict, TSize index) : m_dict(dict), m_index(index) { skip_free(); }
+    auto& operator*() const { return m_dict->m_slots[m_index]; }
+    auto* operator->() const { return m_dict->m_slots + m_index; }
+    Iterator& operator++() {
+      m_index++;
+      skip_free();
+      return *this;
+    }
+    bool operator==(const Iterator& other) const { return m_index == other.m_index; }
+  };
+
+  Dict() = default;
+  Dict(std::initializer_list<Slot> list) {
+    reserve(static_cast<TSize>(list.size()));
+    for (const auto& item: list) {
+      add(item.first, item.second);
+    }
+  }
+  Dict(const Dict& other) {
+    reserve(other.m_size);
+    for (const auto& item: other) {
+      insert_new(item.first, item.second);
+    }
+  }
+  Dict(Dict&& other) noexcept
+      : m_slots(std::exchange(other.m_slots, nullptr)), m_ctrl(std::exchange(other.m_ctrl, nullptr)),
+        m_capacity(std::exchange(other.m_capacity, 0)), m_size(std::exchange(other.m_size, 0)),
+        m_deleted(std::exchange(other.m_deleted, 0)) {}
+  Dict& operator=(const Dict& other) {
+    if (this != &other) {
+      *this = Dict(other);
+    }
+    return *this;
+  }
+  Dict& operator=(Dict&& other) noexcept {
+    if (this != &other) {
+      release();
+      m_slots = std::exchange(other.m_slots, nullptr);
+      m_ctrl = std::exchange(other.m_ctrl, nullptr);
+      m_capacity = std::exchange(other.m_capacity, 0);
+      m_size = std::exchange(other.m_size, 0);
+      m_deleted = std::exchange(other.m_deleted, 0);
+    }
+    return *this;
+  }
+  ~Dict() { release(); }
+
+  // Makes room for count items without further rehashing.
+  void reserve(TSize count) {
+    auto capacity = std::max(m_capacity, MinCapacity);
+    while (max_load(capacity) < count) {
+      if (TSIZE_MAX / 2 < capacity) [[unlikely]] {
+        throw Exception("Dict too large: {}", count);
+      }
+      capacity *= 2;
+    }
+    if (capacity != m_capacity) {
+      if (m_capacity == 0) {
+        allocate(capacity);
+      } else {
+        rehash(capacity);
+      }
+    }
+  }
+
+  void clear() { release(); }
+
+  Iterator<true> begin() const { return {this, 0}; }
+  Iterator<true> end() const { return {this, m_capacity}; }
+  Iterator<false> begin() { return {this, 0}; }
+  Iterator<false> end() { return {this, m_capacity}; }
+
+  TSize size() const { return m_size; }
+  TSize capacity() const { return m_capacity; }
+
+  // The hash the table uses for a key; lookup keys hash like the keys they match.
+  template <DictLookupKey<Key> K>
+  static uint64_t hash(const K& key) {
+    return hash_of(key);
+  }
+
+  template <DictLookupKey<Key> K>
+  Value* find(const K& key) {
+    auto index = find_index(key);
+    return index < 0 ? nullptr : &m_slots[index].second;
+  }
+  template <DictLookupKey<Key> K>
+  const Value* find(const K& key) const {
+    auto index = find_index(key);
+    return index < 0 ? nullptr : &m_slots[index].second;
+  }
+
+  template <DictLookupKey<Key> K>
+  Value& operator[](const K& key) {
+    auto value = find(key);
+    if (value == nullptr) {
+      throw Exception("Invalid key");
+    }
+    return *value;
+  }
+  template <DictLookupKey<Key> K>
+  const Value& operator[](const K& key) const {
+    auto value = find(key);
+    if (value == nullptr) {
+      throw Exception("Invalid key");
+    }
+    return *value;
+  }
+
+  template <DictLookupKey<Key> K>
+  const Value& get(const K& key, const Value& default_value = Value()) const {
+    auto value = find(key);
+    return value == nullptr ? default_value : *value;
+  }
+  template <DictLookupKey<Key> K>
+  std::optional<Value> get_opt(const K& key) const {
+    auto value = find(key);
+    if (value == nullptr) {
+      return std::nullopt;
+    }
+    return *value;
+  }
+
+  template <DictLookupKey<Key> K>
+  bool has(const K& key) const {
+    return find_index(key) >= 0;
+  }
+
+  // Inserts the value, or replaces the value already stored for the key.
+  template <typename K, typename V>
+  void add(K&& key, V&& value) {
+    if constexpr (DictLookupKey<std::remove_cvref_t<K>, Key>) {
+      if (auto existing = find(key); existing != nullptr) {
+        *existing = std::forward<V>(value);
+        return;
+      }
+      insert_new(std::forward<K>(key), std::forward<V>(value));
+    } else {
+      add(Key(std::forward<K>(key)), std::forward<V>(value));
+    }
+  }
+
+  // Removes the key, if present; returns whether it was.
+  template <DictLookupKey<Key> K>
+  bool remove(const K& key) {
+    auto index = find_index(key);
+    if (index < 0) {
+      return false;
+    }
+    m_slots[index].~Slot();
+    set_ctrl(index, DictControl::Deleted);
+    m_size--;
+    m_deleted++;
+    return true;
+  }
+
+  Array<Key> keys() const {
+    Array<Key> list(TagReserve{}, m_size);
+    for (const auto& item: *this) {
+      list.push_back(item.first);
+    }
+    return list;
+  }
+  Array<Value> values() const {
+    Array<Value> list(TagReserve{}, m_size);
+    for (const auto& item: *this) {
+      list.push_back(item.second);
+    }
+    return list;
+  }
 };
 
-} // namespace kl
\ No newline at end of file
+template <typename Key, typename Value>
+struct TriviallyRelocatable<Dict<Key, Value>> : std::true_type {};
+
+} // namespace kl
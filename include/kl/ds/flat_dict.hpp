@@ -0,0 +1,203 @@
+#pragma once
+
+#include "pair.hpp"
+#include "array.hpp"
+#include "dict.hpp"
+#include <algorithm>
+#include <compare>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace kl {
+
+/**
+ * @brief Map kept as two parallel arrays, the keys sorted.
+ *
+ * Meant for small or read-mostly maps, such as configuration or headers: the keys are contiguous, so a lookup is a
+ * binary search touching a few cache lines and no nodes, and the whole map is two allocations. The search is
+ * branchless, so its cost does not depend on how well the comparisons can be predicted. Building from an unsorted
+ * Array sorts once; single insertions and removals shift the items after them.
+ *
+ * Keys can be looked up by the same types as in Dict, for instance a Text key by std::string_view.
+ */
+template <typename Key, typename Value>
+class FlatDict {
+  Array<Key> m_keys;
+  Array<Value> m_values;
+
+  template <typename K>
+  static std::strong_ordering compare(const Key& key, const K& lookup) {
+    if constexpr (std::same_as<K, Key>) {
+      return key <=> lookup;
+    } else {
+      return key.to_view() <=> std::string_view(lookup);
+    }
+  }
+  template <typename K>
+  static bool equals(const Key& key, const K& lookup) {
+    if constexpr (std::same_as<K, Key>) {
+      return key == lookup;
+    } else {
+      return key.to_view() == std::string_view(lookup);
+    }
+  }
+
+  // Position of the last key not greater than the lookup key; 0 when there is none, or the map is empty. The loop
+  // halves the range with a conditional move instead of a branch, and one comparison per step.
+  template <typename K>
+  TSize search(const K& key) const {
+    auto n = m_keys.size();
+    const Key* base = m_keys.begin();
+    while (n > 1) {
+      auto half = n / 2;
+      base = compare(base[half], key) <= 0 ? base + half : base;
+      n -= half;
+    }
+    return static_cast<TSize>(base - m_keys.begin());
+  }
+
+  template <typename K>
+  TSize find_index(const K& key) const {
+    if (m_keys.size() == 0) {
+      return -1;
+    }
+    auto index = search(key);
+    return equals(m_keys.begin()[index], key) ? index : -1;
+  }
+
+public:
+  template <bool Const>
+  class Iterator {
+    using DictType = std::conditional_t<Const, const FlatDict, FlatDict>;
+    DictType* m_dict;
+    TSize m_index;
+
+  public:
+    Iterator(DictType* dict, TSize index) : m_dict(dict), m_index(index) {}
+    auto operator*() const {
+      using ValueRef = std::conditional_t<Const, const Value&, Value&>;
+      return Pair<const Key&, ValueRef>{m_dict->m_keys.begin()[m_index], m_dict->m_values.begin()[m_index]};
+    }
+    Iterator& operator++() {
+      m_index++;
+      return *this;
+    }
+    bool operator==(const Iterator& other) const { return m_index == other.m_index; }
+  };
+
+  FlatDict() = default;
+  // Builds the map with a single sort; for repeated keys the last value wins.
+  explicit FlatDict(Array<Pair<Key, Value>> items) {
+    std::stable_sort(items.begin(), items.end(),
+                     [](const auto& left, const auto& right) { return left.first < right.first; });
+    m_keys.reserve(items.size());
+    m_values.reserve(items.size());
+    for (TSize i = 0; i < items.size(); i++) {
+      auto& item = items.begin()[i];
+      if (i + 1 < items.size() && !(item.first < items.begin()[i + 1].first)) {
+        continue;
+      }
+      m_keys.push_back(std::move(item.first));
+      m_values.push_back(std::move(item.second));
+    }
+  }
+  FlatDict(std::initializer_list<Pair<Key, Value>> list) : FlatDict(Array<Pair<Key, Value>>(list)) {}
+
+  void clear() {
+    m_keys.clear();
+    m_values.clear();
+  }
+
+  Iterator<true> begin() const { return {this, 0}; }
+  Iterator<true> end() const { return {this, m_keys.size()}; }
+  Iterator<false> begin() { return {this, 0}; }
+  Iterator<false> end() { return {this, m_keys.size()}; }
+
+  TSize size() const { return m_keys.size(); }
+
+  template <DictLookupKey<Key> K>
+  Value* find(const K& key) {
+    auto index = find_index(key);
+    return index < 0 ? nullptr : m_values.begin() + index;
+  }
+  template <DictLookupKey<Key> K>
+  const Value* find(const K& key) const {
+    auto index = find_index(key);
+    return index < 0 ? nullptr : m_values.begin() + index;
+  }
+
+  template <DictLookupKey<Key> K>
+  Value& operator[](const K& key) {
+    auto value = find(key);
+    if (value == nullptr) {
+      throw Exception("Invalid key");
+    }
+    return *value;
+  }
+  template <DictLookupKey<Key> K>
+  const Value& operator[](const K& key) const {
+    auto value = find(key);
+    if (value == nullptr) {
+      throw Exception("Invalid key");
+    }
+    return *value;
+  }
+
+  template <DictLookupKey<Key> K>
+  const Value& get(const K& key, const Value& default_value = Value()) const {
+    auto value = find(key);
+    return value == nullptr ? default_value : *value;
+  }
+  template <DictLookupKey<Key> K>
+  std::optional<Value> get_opt(const K& key) const {
+    auto value = find(key);
+    if (value == nullptr) {
+      return std::nullopt;
+    }
+    return *value;
+  }
+
+  template <DictLookupKey<Key> K>
+  bool has(const K& key) const {
+    return find_index(key) >= 0;
+  }
+
+  // Inserts the value, or replaces the value already stored for the key.
+  template <typename K, typename V>
+  void add(K&& key, V&& value) {
+    if constexpr (DictLookupKey<std::remove_cvref_t<K>, Key>) {
+      auto index = search(key);
+      if (m_keys.size() > 0) {
+        auto order = compare(m_keys.begin()[index], key);
+        if (order == 0) {
+          m_values.begin()[index] = std::forward<V>(value);
+          return;
+        }
+        index += order < 0 ? 1 : 0;
+      }
+      m_keys.insert(index, make_dict_key<Key>(std::forward<K>(key)));
+      m_values.insert(index, Value(std::forward<V>(value)));
+    } else {
+      add(Key(std::forward<K>(key)), std::forward<V>(value));
+    }
+  }
+
+  // Removes the key, if present; returns whether it was.
+  template <DictLookupKey<Key> K>
+  bool remove(const K& key) {
+    auto index = find_index(key);
+    if (index < 0) {
+      return false;
+    }
+    m_keys.remove_at(index);
+    m_values.remove_at(index);
+    return true;
+  }
+
+  // The keys, in ascending order, and the values in the same order.
+  const Array<Key>& keys() const { return m_keys; }
+  const Array<Value>& values() const { return m_values; }
+};
+
+} // namespace kl
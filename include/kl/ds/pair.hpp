@@ -1,5 +1,7 @@
 #pragma once
 
+#include <kl/memory/relocation.hpp>
+
 namespace kl {
 template <typename T1, typename T2>
 class Pair {
@@ -7,4 +9,8 @@ public:
   T1 first;
   T2 second;
 };
+
+template <typename T1, typename T2>
+struct TriviallyRelocatable<Pair<T1, T2>>
+    : std::bool_constant<is_trivially_relocatable<T1> && is_trivially_relocatable<T2>> {};
 } // namespace kl
\ No newline at end of file
@@ -0,0 +1,247 @@
+#pragma once
+#include <kl/inttypes.hpp>
+#include <kl/ds/array.hpp>
+#include <kl/ds/cursor.hpp>
+#include <kl/ds/tags.hpp>
+#include <kl/except.hpp>
+#include <kl/memory/blocks.hpp>
+#include <kl/memory/relocation.hpp>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <utility>
+
+namespace kl {
+
+/**
+ * @brief Array that keeps up to N items inside the object, and only allocates when it grows past them.
+ *
+ * Same interface and growth policy as Array. Meant for the many short lists - arguments, path components - that
+ * would otherwise allocate on their first push_back. While the items are inline, moving the SmallArray moves them one
+ * by one; past N it moves like an Array, by taking over the heap storage.
+ */
+template <typename T, TSize N>
+class SmallArray {
+  static_assert(N > 0, "Use Array for lists without inline storage");
+  static constexpr bool InBlocks = is_trivially_relocatable<T> && alignof(T) <= alignof(std::max_align_t);
+
+  T* m_data;
+  TSize m_size = 0;
+  TSize m_reserved = N;
+  alignas(T) std::byte m_inline[N * sizeof(T)];
+
+  T* inline_data() { return reinterpret_cast<T*>(m_inline); }
+
+  TSize flex_index(TSize index) const {
+    if (index < 0) {
+      index += m_size;
+    }
+    return strict_index(index);
+  }
+
+  TSize strict_index(TSize index) const {
+    if (index >= m_size || index < 0) [[unlikely]] {
+      throw Exception("Out of range: {} out of {}", index, m_size);
+    }
+    return index;
+  }
+
+  static T* allocate_items(TSize count) {
+    if constexpr (InBlocks) {
+      return static_cast<T*>(allocate_block(count * sizeof(T)));
+    } else {
+      return static_cast<T*>(::operator new(count * sizeof(T)));
+    }
+  }
+
+  void release_heap() {
+    if (!is_inline()) {
+      if constexpr (InBlocks) {
+        release_block(m_data, m_reserved * sizeof(T));
+      } else {
+        ::operator delete(m_data);
+      }
+    }
+  }
+
+  // Moves the items to the start of an empty storage, leaving their old places destroyed.
+  void relocate_to(T* destination) {
+    if constexpr (is_trivially_relocatable<T>) {
+      if (m_size > 0) {
+        std::memcpy(static_cast<void*>(destination), static_cast<const void*>(m_data), m_size * sizeof(T));
+      }
+    } else {
+      for (TSize i = 0; i < m_size; i++) {
+        new (destination + i) T(std::move(m_data[i]));
+        m_data[i].~T();
+      }
+    }
+  }
+
+  // Takes the items of other, which is left empty and inline.
+  void take(SmallArray& other) {
+    if (other.is_inline()) {
+      m_data = inline_data();
+      m_reserved = N;
+      other.relocate_to(m_data);
+    } else {
+      m_data = other.m_data;
+      m_reserved = other.m_reserved;
+      other.m_data = other.inline_data();
+      other.m_reserved = N;
+    }
+    m_size = std::exchange(other.m_size, 0);
+  }
+
+  void allocate_space_for_next(int count = 1) {
+    if (count < 1) {
+      return;
+    }
+    if (TSIZE_MAX - count < m_size) [[unlikely]] {
+      throw Exception("Out of range");
+    }
+    if (m_size + count > m_reserved) {
+      reserve(grown_capacity(m_reserved, m_size + count));
+    }
+  }
+
+public:
+  SmallArray() : m_data(inline_data()) {}
+  template <typename... Args>
+  SmallArray(TagBuild, TSize size, Args&&... args) : SmallArray(TagReserve{}, size) {
+    for (; m_size < size; m_size++) {
+      new (m_data + m_size) T(std::forward<Args>(args)...);
+    }
+  }
+  SmallArray(TagNoInit, TSize size) : SmallArray(TagReserve{}, size) { m_size = size; }
+  SmallArray(TagReserve, TSize size) : SmallArray() { reserve(size); }
+
+  SmallArray(std::initializer_list<T> list) : SmallArray(TagReserve{}, static_cast<TSize>(list.size())) {
+    for (const auto& item: list) {
+      new (m_data + m_size) T(item);
+      m_size++;
+    }
+  }
+
+  SmallArray(const SmallArray& other) : SmallArray(TagReserve{}, other.m_size) {
+    for (TSize i = 0; i < other.m_size; i++) {
+      new (m_data + i) T(other.m_data[i]);
+      m_size++;
+    }
+  }
+  SmallArray(SmallArray&& other) noexcept { take(other); }
+
+  SmallArray& operator=(const SmallArray& other) {
+    if (this != &other) {
+      *this = SmallArray(other);
+    }
+    return *this;
+  }
+  SmallArray& operator=(SmallArray&& other) noexcept {
+    if (this != &other) {
+      clear();
+      release_heap();
+      take(other);
+    }
+    return *this;
+  }
+
+  ~SmallArray() {
+    clear();
+    release_heap();
+  }
+
+  T& push_back(const T& value) { return emplace_back(value); }
+  T& push_back(T&& value) { return emplace_back(std::move(value)); }
+
+  template <typename... Args>
+  T& emplace_back(Args&&... args) {
+    allocate_space_for_next();
+    new (m_data + m_size) T(std::forward<Args>(args)...);
+    ++m_size;
+    return m_data[m_size - 1];
+  }
+
+  // Inserts the value before the item at index; index can also be size(), appending the value.
+  T& insert(TSize index, T value) {
+    if (index != m_size) {
+      strict_index(index);
+    }
+    allocate_space_for_next();
+    if constexpr (is_trivially_relocatable<T>) {
+      std::memmove(static_cast<void*>(m_data + index + 1), static_cast<const void*>(m_data + index),
+                   (m_size - index) * sizeof(T));
+      new (m_data + index) T(std::move(value));
+    } else if (index == m_size) {
+      new (m_data + m_size) T(std::move(value));
+    } else {
+      new (m_data + m_size) T(std::move(m_data[m_size - 1]));
+      for (TSize i = m_size - 1; i > index; i--) {
+        m_data[i] = std::move(m_data[i - 1]);
+      }
+      m_data[index] = std::move(value);
+    }
+    ++m_size;
+    return m_data[index];
+  }
+
+  void remove_at(TSize index) {
+    index = flex_index(index);
+    if constexpr (is_trivially_relocatable<T>) {
+      m_data[index].~T();
+      std::memmove(static_cast<void*>(m_data + index), static_cast<const void*>(m_data + index + 1),
+                   (m_size - index - 1) * sizeof(T));
+    } else {
+      for (TSize i = index + 1; i < m_size; i++) {
+        m_data[i - 1] = std::move(m_data[i]);
+      }
+      m_data[m_size - 1].~T();
+    }
+    --m_size;
+  }
+
+  void clear() {
+    for (TSize i = 0; i < m_size; i++) {
+      m_data[i].~T();
+    }
+    m_size = 0;
+  }
+
+  void reserve(TSize size) {
+    if (size <= m_reserved) {
+      return;
+    }
+    if constexpr (InBlocks) {
+      if (!is_inline()) {
+        m_data = static_cast<T*>(grow_block(m_data, m_reserved * sizeof(T), size * sizeof(T)));
+        m_reserved = size;
+        return;
+      }
+    }
+    auto new_data = allocate_items(size);
+    relocate_to(new_data);
+    release_heap();
+    m_data = new_data;
+    m_reserved = size;
+  }
+
+  T* begin() const { return m_data; }
+  T* end() const { return m_data + m_size; }
+
+  Cursor first() const { return {0}; }
+  Cursor last() const { return {m_size - 1}; }
+  bool valid(Cursor cur) const { return cur.position() >= 0 && cur.position() < m_size; }
+
+  const T& operator[](TSize index) const { return m_data[flex_index(index)]; }
+  T& operator[](TSize index) { return m_data[flex_index(index)]; }
+  const T& operator[](Cursor index) const { return m_data[strict_index(index.position())]; }
+  T& operator[](Cursor index) { return m_data[strict_index(index.position())]; }
+
+  TSize size() const { return m_size; }
+  TSize reserved() const { return m_reserved; }
+  T* data() const { return m_data; }
+  // Whether the items are still stored inside the object.
+  bool is_inline() const { return m_data == reinterpret_cast<const T*>(m_inline); }
+};
+
+} // namespace kl
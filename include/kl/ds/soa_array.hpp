@@ -0,0 +1,280 @@
+#pragma once
+#include <kl/inttypes.hpp>
+#include <kl/ds/array.hpp>
+#include <kl/ds/cursor.hpp>
+#include <kl/ds/tags.hpp>
+#include <kl/except.hpp>
+#include <kl/memory/blocks.hpp>
+#include <kl/memory/relocation.hpp>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace kl {
+
+// A row of an SoAArray: the fields of one item, each in its own column. Supports structured bindings, which bind
+// references to the fields.
+template <bool Const, typename... Fields>
+class SoARow {
+  const std::tuple<Fields*...>* m_columns;
+  TSize m_index;
+
+public:
+  SoARow(const std::tuple<Fields*...>* columns, TSize index) : m_columns(columns), m_index(index) {}
+
+  template <size_t I>
+  decltype(auto) get() const {
+    auto& field = std::get<I>(*m_columns)[m_index];
+    if constexpr (Const) {
+      return static_cast<const std::remove_reference_t<decltype(field)>&>(field);
+    } else {
+      return field;
+    }
+  }
+  TSize index() const { return m_index; }
+};
+
+/**
+ * @brief List of records stored as one contiguous column per field.
+ *
+ * Scans over a few fields of many records read only those fields' columns, instead of whole records, and the columns
+ * can be handed to vectorized code as spans. Growth and indexing work as in Array: the same capacity steps, negative
+ * indexes counting from the end, Cursors checked strictly. Items are read and written through SoARow proxies, which,
+ * like references into an Array, are invalidated when the columns grow.
+ */
+template <typename... Fields>
+class SoAArray {
+  static_assert(sizeof...(Fields) > 0, "An SoAArray needs at least one field");
+  static_assert(((alignof(Fields) <= alignof(std::max_align_t)) && ...), "Over-aligned fields are not supported");
+
+  template <size_t I>
+  using Field = std::tuple_element_t<I, std::tuple<Fields...>>;
+  static constexpr auto Indexes = std::index_sequence_for<Fields...>{};
+
+  std::tuple<Fields*...> m_columns{};
+  TSize m_size = 0;
+  TSize m_reserved = 0;
+
+  TSize flex_index(TSize index) const {
+    if (index < 0) {
+      index += m_size;
+    }
+    return strict_index(index);
+  }
+
+  TSize strict_index(TSize index) const {
+    if (index >= m_size || index < 0) [[unlikely]] {
+      throw Exception("Out of range: {} out of {}", index, m_size);
+    }
+    return index;
+  }
+
+  // Calls fn with a reference to each column pointer.
+  template <typename Fn>
+  void for_columns(Fn&& fn) {
+    std::apply([&](auto*&... columns) { (fn(columns), ...); }, m_columns);
+  }
+
+  template <typename F>
+  static F* allocate_column(TSize count) {
+    return count > 0 ? static_cast<F*>(allocate_block(count * sizeof(F))) : nullptr;
+  }
+
+  // Moves the column to storage for size items, the same way Array::reserve moves its items.
+  template <typename F>
+  void grow_column(F*& column, TSize size) {
+    if constexpr (is_trivially_relocatable<F>) {
+      column = static_cast<F*>(grow_block(column, m_reserved * sizeof(F), size * sizeof(F)));
+    } else {
+      auto grown = allocate_column<F>(size);
+      for (TSize i = 0; i < m_size; i++) {
+        new (grown + i) F(std::move(column[i]));
+        column[i].~F();
+      }
+      release_block(column, m_reserved * sizeof(F));
+      column = grown;
+    }
+  }
+
+  void release_data() {
+    for_columns([this]<typename F>(F*& column) {
+      std::destroy_n(column, m_size);
+      release_block(column, m_reserved * sizeof(F));
+      column = nullptr;
+    });
+  }
+
+  template <typename F>
+  void insert_into(F* column, TSize index, F&& value) {
+    if constexpr (is_trivially_relocatable<F>) {
+      std::memmove(static_cast<void*>(column + index + 1), static_cast<const void*>(column + index),
+                   (m_size - index) * sizeof(F));
+      new (column + index) F(std::move(value));
+    } else if (index == m_size) {
+      new (column + m_size) F(std::move(value));
+    } else {
+      new (column + m_size) F(std::move(column[m_size - 1]));
+      std::move_backward(column + index, column + m_size - 1, column + m_size);
+      column[index] = std::move(value);
+    }
+  }
+
+  template <typename F>
+  void remove_from(F* column, TSize index) {
+    if constexpr (is_trivially_relocatable<F>) {
+      column[index].~F();
+      std::memmove(static_cast<void*>(column + index), static_cast<const void*>(column + index + 1),
+                   (m_size - index - 1) * sizeof(F));
+    } else {
+      std::move(column + index + 1, column + m_size, column + index);
+      column[m_size - 1].~F();
+    }
+  }
+
+  template <size_t... I>
+  void copy_columns(const SoAArray& other, std::index_sequence<I...>) {
+    (std::uninitialized_copy_n(std::get<I>(other.m_columns), other.m_size, std::get<I>(m_columns)), ...);
+  }
+
+  void allocate_space_for_next(int count = 1) {
+    if (count < 1) {
+      return;
+    }
+    if (TSIZE_MAX - count < m_size) [[unlikely]] {
+      throw Exception("Out of range");
+    }
+    if (m_size + count > m_reserved) {
+      reserve(grown_capacity(m_reserved, m_size + count));
+    }
+  }
+
+public:
+  template <bool Const>
+  class Iterator {
+    const std::tuple<Fields*...>* m_columns;
+    TSize m_index;
+
+  public:
+    Iterator(const std::tuple<Fields*...>* columns, TSize index) : m_columns(columns), m_index(index) {}
+    SoARow<Const, Fields...> operator*() const { return {m_columns, m_index}; }
+    Iterator& operator++() {
+      m_index++;
+      return *this;
+    }
+    bool operator==(const Iterator& other) const { return m_index == other.m_index; }
+  };
+
+  SoAArray() = default;
+  // size items with default-constructed fields.
+  SoAArray(TagBuild, TSize size) : SoAArray(TagReserve{}, size) {
+    for_columns([size]<typename F>(F* column) { std::uninitialized_value_construct_n(column, size); });
+    m_size = size;
+  }
+  SoAArray(TagReserve, TSize size) { reserve(size); }
+
+  SoAArray(const SoAArray& other) : SoAArray(TagReserve{}, other.m_size) {
+    copy_columns(other, Indexes);
+    m_size = other.m_size;
+  }
+  SoAArray(SoAArray&& other) noexcept
+      : m_columns(std::exchange(other.m_columns, {})), m_size(std::exchange(other.m_size, 0)),
+        m_reserved(std::exchange(other.m_reserved, 0)) {}
+
+  SoAArray& operator=(const SoAArray& other) {
+    if (this != &other) {
+      *this = SoAArray(other);
+    }
+    return *this;
+  }
+  SoAArray& operator=(SoAArray&& other) noexcept {
+    if (this != &other) {
+      release_data();
+      m_columns = std::exchange(other.m_columns, {});
+      m_size = std::exchange(other.m_size, 0);
+      m_reserved = std::exchange(other.m_reserved, 0);
+    }
+    return *this;
+  }
+
+  ~SoAArray() { release_data(); }
+
+  SoARow<false, Fields...> push_back(Fields... values) {
+    allocate_space_for_next();
+    std::apply([&](auto*... columns) { (new (columns + m_size) Fields(std::move(values)), ...); }, m_columns);
+    ++m_size;
+    return {&m_columns, m_size - 1};
+  }
+
+  // Inserts the item before the one at index; index can also be size(), appending the item.
+  SoARow<false, Fields...> insert(TSize index, Fields... values) {
+    if (index != m_size) {
+      strict_index(index);
+    }
+    allocate_space_for_next();
+    std::apply([&](auto*... columns) { (insert_into(columns, index, std::move(values)), ...); }, m_columns);
+    ++m_size;
+    return {&m_columns, index};
+  }
+
+  void remove_at(TSize index) {
+    index = flex_index(index);
+    for_columns([this, index](auto* column) { remove_from(column, index); });
+    --m_size;
+  }
+
+  void clear() {
+    for_columns([this](auto* column) { std::destroy_n(column, m_size); });
+    m_size = 0;
+  }
+
+  void reserve(TSize size) {
+    if (size > m_reserved) {
+      for_columns([this, size](auto*& column) { grow_column(column, size); });
+      m_reserved = size;
+    }
+  }
+
+  Iterator<true> begin() const { return {&m_columns, 0}; }
+  Iterator<true> end() const { return {&m_columns, m_size}; }
+  Iterator<false> begin() { return {&m_columns, 0}; }
+  Iterator<false> end() { return {&m_columns, m_size}; }
+
+  Cursor first() const { return {0}; }
+  Cursor last() const { return {m_size - 1}; }
+  bool valid(Cursor cur) const { return cur.position() >= 0 && cur.position() < m_size; }
+
+  SoARow<true, Fields...> operator[](TSize index) const { return {&m_columns, flex_index(index)}; }
+  SoARow<false, Fields...> operator[](TSize index) { return {&m_columns, flex_index(index)}; }
+  SoARow<true, Fields...> operator[](Cursor index) const { return {&m_columns, strict_index(index.position())}; }
+  SoARow<false, Fields...> operator[](Cursor index) { return {&m_columns, strict_index(index.position())}; }
+
+  // The I-th field of all the items, contiguous.
+  template <size_t I>
+  std::span<const Field<I>> column() const {
+    return {std::get<I>(m_columns), static_cast<size_t>(m_size)};
+  }
+  template <size_t I>
+  std::span<Field<I>> column() {
+    return {std::get<I>(m_columns), static_cast<size_t>(m_size)};
+  }
+
+  TSize size() const { return m_size; }
+  TSize reserved() const { return m_reserved; }
+};
+
+template <typename... Fields>
+struct TriviallyRelocatable<SoAArray<Fields...>> : std::true_type {};
+
+} // namespace kl
+
+template <bool Const, typename... Fields>
+struct std::tuple_size<kl::SoARow<Const, Fields...>> : std::integral_constant<size_t, sizeof...(Fields)> {};
+
+template <size_t I, bool Const, typename... Fields>
+struct std::tuple_element<I, kl::SoARow<Const, Fields...>> {
+  using type = decltype(std::declval<kl::SoARow<Const, Fields...>>().template get<I>());
+};
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "pair.hpp"
+#include "dict.hpp"
+#include <kl/hash.hpp>
+#include <kl/text.hpp>
+#include <bit>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace kl {
+
+/**
+ * @brief Map with a fixed set of Text keys, hashed without collisions.
+ *
+ * The keys are known when the map is built, usually at compile time from `_t` literals, whose hashes are computed by
+ * the compiler as well. The build finds a perfect hash in the style of PTHash: the keys are split by hash into small
+ * buckets, and each bucket gets a pilot value, chosen so that the hash mixed with the pilot sends every key of the
+ * bucket to a slot no other key uses. A lookup is then one hash, one pilot and one key comparison, without probing.
+ *
+ * Lookups take the same types as Dict lookups on Text keys: Text, std::string_view or C strings.
+ *
+ * @code
+ * constexpr Pair<Text, int> MethodNames[] = {{"GET"_t, 1}, {"POST"_t, 2}, {"PUT"_t, 3}};
+ * constexpr StaticDict<int, 3> Methods(MethodNames);
+ * static_assert(Methods["POST"_t] == 2);
+ * @endcode
+ */
+template <typename Value, TSize N>
+class StaticDict {
+  static_assert(N > 0, "A StaticDict needs at least one key");
+  static constexpr TSize Slots = std::bit_ceil(static_cast<uint32_t>(N + N / 4));
+  static constexpr TSize Buckets = std::bit_ceil(static_cast<uint32_t>(N / 2 > 0 ? N / 2 : 1));
+  static constexpr uint64_t MaxPilot = 1 << 20;
+
+  Pair<Text, Value> m_items[N];
+  uint64_t m_pilots[Buckets] = {};
+  TSize m_slots[Slots] = {}; // item index, or -1 for a free slot
+
+  static constexpr TSize bucket_of(uint64_t hash) { return static_cast<TSize>((hash >> 32) & (Buckets - 1)); }
+  static constexpr uint64_t pilot_mix(uint64_t pilot) {
+    return wyhash::mix(pilot ^ wyhash::Secret[2], wyhash::Secret[3]);
+  }
+  // Mixed again after the pilot, so that keys whose hashes share the low bits can still be told apart.
+  static constexpr TSize slot_of(uint64_t hash, uint64_t pilot) {
+    return static_cast<TSize>(wyhash::mix(hash ^ pilot, wyhash::Secret[1]) & (Slots - 1));
+  }
+
+  template <typename K>
+  static constexpr uint64_t hash_of(const K& key) {
+    if constexpr (std::same_as<K, Text>) {
+      return key.hash();
+    } else {
+      std::string_view view(key);
+      return hash_bytes(view.data(), view.size());
+    }
+  }
+  template <typename K>
+  static constexpr bool equals(const Text& key, const K& lookup) {
+    if constexpr (std::same_as<K, Text>) {
+      return key == lookup;
+    } else {
+      return key.to_view() == std::string_view(lookup);
+    }
+  }
+
+  // Places the buckets largest first, while there are most free slots, trying pilots until one fits.
+  constexpr void build() {
+    uint64_t hashes[N] = {};
+    TSize bucket_sizes[Buckets] = {};
+    for (TSize i = 0; i < N; i++) {
+      hashes[i] = m_items[i].first.hash();
+      bucket_sizes[bucket_of(hashes[i])]++;
+      for (TSize j = 0; j < i; j++) {
+        if (hashes[i] == hashes[j] && m_items[i].first == m_items[j].first) {
+          throw Exception("Duplicate key in StaticDict");
+        }
+      }
+    }
+    TSize order[Buckets] = {};
+    for (TSize i = 0; i < Buckets; i++) {
+      auto j = i;
+      for (; j > 0 && bucket_sizes[order[j - 1]] < bucket_sizes[i]; j--) {
+        order[j] = order[j - 1];
+      }
+      order[j] = i;
+    }
+    for (auto& slot: m_slots) {
+      slot = -1;
+    }
+
+    TSize members[N] = {};
+    TSize positions[N] = {};
+    for (auto bucket: order) {
+      TSize count = 0;
+      for (TSize i = 0; i < N; i++) {
+        if (bucket_of(hashes[i]) == bucket) {
+          members[count++] = i;
+        }
+      }
+      if (count == 0) {
+        break;
+      }
+      auto placed = false;
+      for (uint64_t pilot = 0; pilot < MaxPilot && !placed; pilot++) {
+        auto mixed = pilot_mix(pilot);
+        placed = true;
+        for (TSize k = 0; k < count && placed; k++) {
+          positions[k] = slot_of(hashes[members[k]], mixed);
+          placed = m_slots[positions[k]] < 0;
+          for (TSize previous = 0; previous < k && placed; previous++) {
+            placed = positions[previous] != positions[k];
+          }
+        }
+        if (placed) {
+          m_pilots[bucket] = mixed;
+          for (TSize k = 0; k < count; k++) {
+            m_slots[positions[k]] = members[k];
+          }
+        }
+      }
+      if (!placed) [[unlikely]] {
+        throw Exception("Could not find a perfect hash for the StaticDict keys");
+      }
+    }
+  }
+
+  template <typename K>
+  constexpr TSize find_index(const K& key) const {
+    auto hash = hash_of(key);
+    auto index = m_slots[slot_of(hash, m_pilots[bucket_of(hash)])];
+    return index >= 0 && equals(m_items[index].first, key) ? index : -1;
+  }
+
+  template <size_t... Index>
+  constexpr StaticDict(const Pair<Text, Value> (&items)[N], std::index_sequence<Index...>) : m_items{items[Index]...} {
+    build();
+  }
+
+public:
+  constexpr StaticDict(const Pair<Text, Value> (&items)[N]) : StaticDict(items, std::make_index_sequence<N>{}) {}
+
+  // The items, in the order they were given.
+  constexpr const Pair<Text, Value>* begin() const { return m_items; }
+  constexpr const Pair<Text, Value>* end() const { return m_items + N; }
+  constexpr TSize size() const { return N; }
+
+  template <DictLookupKey<Text> K>
+  constexpr const Value* find(const K& key) const {
+    auto index = find_index(key);
+    return index < 0 ? nullptr : &m_items[index].second;
+  }
+
+  template <DictLookupKey<Text> K>
+  constexpr const Value& operator[](const K& key) const {
+    auto value = find(key);
+    if (value == nullptr) {
+      throw Exception("Invalid key");
+    }
+    return *value;
+  }
+
+  template <DictLookupKey<Text> K>
+  constexpr const Value& get(const K& key, const Value& default_value = Value()) const {
+    auto value = find(key);
+    return value == nullptr ? default_value : *value;
+  }
+  template <DictLookupKey<Text> K>
+  constexpr std::optional<Value> get_opt(const K& key) const {
+    auto value = find(key);
+    if (value == nullptr) {
+      return std::nullopt;
+    }
+    return *value;
+  }
+
+  template <DictLookupKey<Text> K>
+  constexpr bool has(const K& key) const {
+    return find_index(key) >= 0;
+  }
+};
+
+} // namespace kl
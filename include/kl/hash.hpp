@@ -0,0 +1,88 @@
+#pragma once
+#include <kl/inttypes.hpp>
+#include <cstring>
+
+namespace kl {
+
+namespace wyhash {
+
+constexpr uint64_t Secret[4] = {0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull,
+                                0x4d5a2da51de1aa47ull};
+
+constexpr void multiply(uint64_t& a, uint64_t& b) {
+  auto r = static_cast<unsigned __int128>(a) * b;
+  a = static_cast<uint64_t>(r);
+  b = static_cast<uint64_t>(r >> 64);
+}
+
+constexpr uint64_t mix(uint64_t a, uint64_t b) {
+  multiply(a, b);
+  return a ^ b;
+}
+
+template <typename T>
+constexpr T read(const char* p) {
+  if consteval {
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); i++) {
+      value |= static_cast<T>(static_cast<TByte>(p[i])) << (8 * i);
+    }
+    return value;
+  } else {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+  }
+}
+
+constexpr uint64_t read3(const char* p, size_t k) {
+  return (static_cast<uint64_t>(static_cast<TByte>(p[0])) << 16) |
+         (static_cast<uint64_t>(static_cast<TByte>(p[k >> 1])) << 8) | static_cast<TByte>(p[k - 1]);
+}
+
+} // namespace wyhash
+
+// wyhash (final version 4) of [p, p + len). Usable in constant expressions, where it yields the same value as at
+// runtime, so hashes of literals can be computed by the compiler.
+constexpr uint64_t hash_bytes(const char* p, size_t len, uint64_t seed = 0) {
+  using namespace wyhash;
+  seed ^= mix(seed ^ Secret[0], Secret[1]);
+  uint64_t a = 0;
+  uint64_t b = 0;
+  if (len <= 16) {
+    if (len >= 4) {
+      auto offset = (len >> 3) << 2;
+      a = (static_cast<uint64_t>(read<uint32_t>(p)) << 32) | read<uint32_t>(p + offset);
+      b = (static_cast<uint64_t>(read<uint32_t>(p + len - 4)) << 32) | read<uint32_t>(p + len - 4 - offset);
+    } else if (len > 0) {
+      a = read3(p, len);
+    }
+  } else {
+    auto i = len;
+    if (i > 48) {
+      auto seed1 = seed;
+      auto seed2 = seed;
+      do {
+        seed = mix(read<uint64_t>(p) ^ Secret[1], read<uint64_t>(p + 8) ^ seed);
+        seed1 = mix(read<uint64_t>(p + 16) ^ Secret[2], read<uint64_t>(p + 24) ^ seed1);
+        seed2 = mix(read<uint64_t>(p + 32) ^ Secret[3], read<uint64_t>(p + 40) ^ seed2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= seed1 ^ seed2;
+    }
+    while (i > 16) {
+      seed = mix(read<uint64_t>(p) ^ Secret[1], read<uint64_t>(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    a = read<uint64_t>(p + i - 16);
+    b = read<uint64_t>(p + i - 8);
+  }
+  a ^= Secret[1];
+  b ^= seed;
+  multiply(a, b);
+  return mix(a ^ Secret[0] ^ len, b ^ Secret[1]);
+}
+
+} // namespace kl
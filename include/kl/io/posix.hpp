@@ -0,0 +1,12 @@
+#pragma once
+#include <span>
+#include <sys/uio.h>
+
+namespace kl::posix {
+
+// Writes the buffers to the file descriptor in order, with writev, at most IOV_MAX of them per call. Partial writes
+// are resumed from where they stopped, and interrupted ones retried; the buffers are advanced past what was written.
+// Throws kl::Exception when a write fails.
+void write_all(int fd, std::span<iovec> parts);
+
+} // namespace kl::posix
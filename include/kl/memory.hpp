@@ -3,6 +3,11 @@
 // We will not implement our own version of std::move
 #include <utility>
 
+#include <kl/memory/allocation_stats.hpp>
 #include <kl/memory/unique_pointers.hpp>
 #include <kl/memory/pointer.hpp>
+#include <kl/memory/relocation.hpp>
+#include <kl/memory/resource.hpp>
 #include <kl/memory/ref_counted_pointer.hpp>
+#include <kl/memory/intrusive_pointer.hpp>
+#include <kl/memory/object_pool.hpp>
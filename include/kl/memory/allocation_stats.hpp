@@ -0,0 +1,70 @@
+#pragma once
+#include <kl/inttypes.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Counters of the memory held by kl types, by category, for exporting to metrics. They are only kept in builds with
+// KL_ALLOCATION_STATS defined (the KL_ALLOCATION_STATS CMake option); otherwise the tracking calls are empty inline
+// functions, and allocation_stats() reports zeros.
+namespace kl {
+
+enum class AllocationCategory {
+  // Text buffers allocated by TextRefCountedBase::allocate, from the heap or a TextResourceScope's resource.
+  Text,
+  // Array storage, from any memory resource.
+  Array,
+  // Objects of make_ptr and make_array_ptr, and the blocks of the shareable pointers, from make_shareable and its
+  // variants, and of SharedArrayPointer.
+  Pointer,
+};
+constexpr TSize AllocationCategoryCount = 3;
+
+#ifdef KL_ALLOCATION_STATS
+constexpr bool AllocationStatsEnabled = true;
+#else
+constexpr bool AllocationStatsEnabled = false;
+#endif
+
+constexpr TSize AllocationSizeBuckets = 32;
+
+struct AllocationStats {
+  int64_t live_bytes = 0;
+  int64_t peak_bytes = 0;
+  int64_t allocations = 0;
+  int64_t releases = 0;
+  // Allocations by size: bucket i counts those of 2^i to 2^(i+1)-1 bytes; the first one also counts empty ones, and
+  // the last one all those of 2^31 bytes and more.
+  std::array<int64_t, AllocationSizeBuckets> sizes{};
+};
+
+// The counters of a category since the program started. Each counter is read atomically, but not all of them together:
+// allocations on other threads can show in some counters and not yet in others.
+AllocationStats allocation_stats(AllocationCategory category);
+
+// Selects the constructors of UniquePointer and UniqueArrayPointer that count the object they take as allocated, for
+// make_ptr and make_array_ptr. Pointers made that way count their object's release too; others count nothing.
+struct TagCountedAllocation {};
+
+namespace allocation_tracking {
+void record_allocation(AllocationCategory category, size_t bytes) noexcept;
+void record_release(AllocationCategory category, size_t bytes) noexcept;
+} // namespace allocation_tracking
+
+constexpr void track_allocation([[maybe_unused]] AllocationCategory category, [[maybe_unused]] size_t bytes) noexcept {
+#ifdef KL_ALLOCATION_STATS
+  if !consteval {
+    allocation_tracking::record_allocation(category, bytes);
+  }
+#endif
+}
+
+constexpr void track_release([[maybe_unused]] AllocationCategory category, [[maybe_unused]] size_t bytes) noexcept {
+#ifdef KL_ALLOCATION_STATS
+  if !consteval {
+    allocation_tracking::record_release(category, bytes);
+  }
+#endif
+}
+
+} // namespace kl
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstddef>
+
+// Growable storage for items that can be moved by copying their bytes (see relocation.hpp). Growing such a block
+// never moves the items one by one: small blocks come from malloc and grow with realloc, which can often extend them
+// in place; blocks of MappedBlockSize bytes and more are mapped directly, aligned to huge pages, and grow with
+// mremap, which extends the mapping or moves its pages without copying them.
+namespace kl {
+
+constexpr size_t MappedBlockSize = 4 << 20;
+
+// A block of at least the given size, or nullptr for 0 bytes.
+void* allocate_block(size_t bytes);
+// The block grown to new_bytes, possibly at another address, with the first `bytes` bytes preserved.
+void* grow_block(void* block, size_t bytes, size_t new_bytes);
+// Frees a block; bytes is the size it was allocated or last grown with.
+void release_block(void* block, size_t bytes);
+
+} // namespace kl
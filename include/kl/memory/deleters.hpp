@@ -14,4 +14,12 @@ struct DefaultMultiDeleter {
   void operator()(T* ptr) { delete[] ptr; }
 };
 
+// The same kind of deleter, for another type: DefaultDeleter<U> for DefaultDeleter<T>.
+template <typename Deleter, typename U>
+struct RebindDeleter;
+template <template <typename> class Deleter, typename T, typename U>
+struct RebindDeleter<Deleter<T>, U> {
+  using type = Deleter<U>;
+};
+
 } // namespace kl
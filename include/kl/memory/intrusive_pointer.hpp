@@ -0,0 +1,126 @@
+#pragma once
+#include <kl/memory/ref_counted_pointer.hpp>
+#include <kl/memory/relocation.hpp>
+#include <kl/except.hpp>
+#include <kl/inttypes.hpp>
+#include <concepts>
+#include <utility>
+
+namespace kl {
+
+/**
+ * @brief Base class for objects that count their own references, for IntrusivePointer.
+ *
+ * The count lives inside the object: one allocation, no header in front of it, and any member function can hand out
+ * a new IntrusivePointer to `this`. The object is deleted through a Derived pointer when its last reference goes,
+ * so hierarchies deriving from one RefCounted base need a virtual destructor in that base.
+ *
+ * @code
+ * class Stream : public RefCounted<Stream> {
+ * public:
+ *   virtual ~Stream() = default;
+ * };
+ * class FileStream : public Stream {};
+ * IntrusivePointer<Stream> stream = make_intrusive<FileStream>();
+ * @endcode
+ */
+template <typename Derived, RefCounting Counting = RefCounting::Local>
+class RefCounted {
+  mutable RefCount<TSize, Counting> m_reference_count = 0;
+
+protected:
+  constexpr RefCounted() noexcept = default;
+  // Copies are new objects, without references.
+  constexpr RefCounted(const RefCounted&) noexcept {}
+  constexpr RefCounted& operator=(const RefCounted&) noexcept { return *this; }
+  constexpr ~RefCounted() = default;
+
+public:
+  constexpr void add_ref() const noexcept { add_ref_count(m_reference_count); }
+  constexpr void release() const noexcept {
+    if (!remove_ref_count(m_reference_count)) {
+      delete static_cast<const Derived*>(this);
+    }
+  }
+  constexpr TSize reference_count() const noexcept { return m_reference_count; }
+};
+
+// Types that IntrusivePointer can hold: anything with add_ref() and release(), like RefCounted.
+template <typename T>
+concept IntrusivelyCounted = requires(const T& value) {
+  value.add_ref();
+  value.release();
+};
+
+template <typename T>
+class IntrusivePointer {
+  T* m_ptr = nullptr;
+
+  template <typename U>
+  friend class IntrusivePointer;
+
+public:
+  constexpr IntrusivePointer() noexcept = default;
+  constexpr IntrusivePointer(std::nullptr_t) noexcept {}
+  // Takes a new reference on the object, which can be `this` of an object already owned by other pointers.
+  constexpr explicit IntrusivePointer(T* ptr) noexcept : m_ptr(ptr) {
+    static_assert(IntrusivelyCounted<T>, "IntrusivePointer needs add_ref() and release(), see RefCounted");
+    if (m_ptr) {
+      m_ptr->add_ref();
+    }
+  }
+
+  constexpr IntrusivePointer(const IntrusivePointer& val) noexcept : IntrusivePointer(val.m_ptr) {}
+  constexpr IntrusivePointer(IntrusivePointer&& val) noexcept : m_ptr(std::exchange(val.m_ptr, nullptr)) {}
+  template <typename U>
+    requires std::convertible_to<U*, T*>
+  constexpr IntrusivePointer(const IntrusivePointer<U>& val) noexcept : IntrusivePointer(static_cast<T*>(val.m_ptr)) {}
+  template <typename U>
+    requires std::convertible_to<U*, T*>
+  constexpr IntrusivePointer(IntrusivePointer<U>&& val) noexcept : m_ptr(std::exchange(val.m_ptr, nullptr)) {}
+
+  constexpr IntrusivePointer& operator=(const IntrusivePointer& val) noexcept {
+    // the new reference comes first, in case val is owned by the object this pointer releases
+    IntrusivePointer copy(val);
+    std::swap(m_ptr, copy.m_ptr);
+    return *this;
+  }
+  constexpr IntrusivePointer& operator=(IntrusivePointer&& val) noexcept {
+    if (&val != this) {
+      // val is emptied before the release, which can destroy the object owning val
+      auto old = std::exchange(m_ptr, std::exchange(val.m_ptr, nullptr));
+      if (old) {
+        old->release();
+      }
+    }
+    return *this;
+  }
+  constexpr ~IntrusivePointer() noexcept { reset(); }
+
+  constexpr void reset() noexcept {
+    if (m_ptr) {
+      std::exchange(m_ptr, nullptr)->release();
+    }
+  }
+
+  constexpr T* get() const noexcept { return m_ptr; }
+  constexpr explicit operator bool() const noexcept { return m_ptr != nullptr; }
+  constexpr T* operator->() const {
+    if (m_ptr == nullptr) [[unlikely]] {
+      throw Exception("Null dereference");
+    }
+    return m_ptr;
+  }
+  constexpr T& operator*() const { return *operator->(); }
+  constexpr bool operator==(const IntrusivePointer& other) const noexcept = default;
+};
+
+template <typename T, typename... Args>
+constexpr IntrusivePointer<T> make_intrusive(Args&&... args) {
+  return IntrusivePointer<T>(new T(std::forward<Args>(args)...));
+}
+
+template <typename T>
+struct TriviallyRelocatable<IntrusivePointer<T>> : std::true_type {};
+
+} // namespace kl
@@ -0,0 +1,154 @@
+#pragma once
+#include <kl/memory/ref_counted_pointer.hpp>
+#include <kl/memory/unique_pointers.hpp>
+#include <kl/inttypes.hpp>
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace kl {
+
+/**
+ * @brief Fixed-size blocks for objects created and destroyed at high rates, cached per thread.
+ *
+ * Each thread allocates from and releases to its own free list of the pool, without locking. An empty list takes a
+ * batch of blocks from the pool's central list, and a list grown past two batches gives one batch back, both under the
+ * pool's lock. The central list carves its new blocks out of slabs of SlabSize bytes, aligned to their size, which
+ * start with a pointer to their pool, so a block is released knowing only its address, by any thread.
+ *
+ * Slabs are freed with the pool only, so the pool must outlive the blocks allocated from it.
+ *
+ * make_ptr allocates sizeof(T) bytes from the pool, while make_shareable and its variants allocate the value with its
+ * reference counts: pools for shareable pointers need blocks of ShareableBlockSize<T> bytes.
+ *
+ * @code
+ * ObjectPool pool(sizeof(Message));
+ * auto message = make_ptr<Message>(pool, "hello"); // freed back to the pool by PoolDeleter
+ * ObjectPool shared_pool(ShareableBlockSize<Message>);
+ * auto shared = make_atomic_shareable<Message>(shared_pool, "hello");
+ * @endcode
+ */
+class ObjectPool {
+public:
+  static constexpr size_t SlabSize = 64 * 1024;
+  static constexpr size_t BlockAlignment = alignof(std::max_align_t);
+  static constexpr size_t MaxBlockSize = SlabSize / 16;
+
+  // Blocks of block_size bytes, rounded up to BlockAlignment.
+  explicit ObjectPool(size_t block_size);
+  ObjectPool(const ObjectPool&) = delete;
+  ObjectPool& operator=(const ObjectPool&) = delete;
+  ~ObjectPool();
+
+  // A block of block_size() bytes; bytes, the size needed, can't be larger.
+  void* allocate(size_t bytes);
+  // Returns a block allocated by any ObjectPool to its pool, through this thread's list.
+  static void release(void* block) noexcept;
+
+  size_t block_size() const { return m_block_size; }
+
+private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+  struct Slab {
+    ObjectPool* pool;
+    Slab* next;
+  };
+  struct Cache;
+  struct ThreadCaches;
+
+  Cache& thread_cache();
+  void refill(Cache& cache);
+  void give_back(FreeBlock* first, FreeBlock* last);
+
+  uint64_t m_id;
+  size_t m_block_size;
+  TSize m_batch;
+  std::mutex m_lock;
+  FreeBlock* m_free = nullptr;
+  Slab* m_slabs = nullptr;
+  // The part of the newest slab not carved into blocks yet.
+  TByte* m_carved = nullptr;
+  TByte* m_slab_end = nullptr;
+};
+
+// ObjectPools of 16, 32, 64 ... MaxBlockSize bytes; each allocation comes from the smallest one that fits.
+class SizedObjectPools {
+  static constexpr TSize ClassCount = 9;
+  static_assert(size_t{16} << (ClassCount - 1) == ObjectPool::MaxBlockSize);
+
+  UniquePointer<ObjectPool> m_pools[ClassCount];
+
+public:
+  SizedObjectPools();
+
+  void* allocate(size_t bytes) { return pool_for(bytes).allocate(bytes); }
+  ObjectPool& pool_for(size_t bytes);
+
+  static SizedObjectPools& shared();
+};
+
+// The block size make_shareable and its variants allocate for a T, with either kind of counts.
+template <typename T>
+constexpr size_t ShareableBlockSize =
+    std::max(sizeof(RefCountedValue<T, RefCounting::Local>), sizeof(RefCountedValue<T, RefCounting::Atomic>));
+
+template <typename P>
+concept ObjectPoolTarget = std::same_as<P, ObjectPool> || std::same_as<P, SizedObjectPools>;
+
+// Destroys objects allocated from an ObjectPool and returns their blocks to it.
+template <typename T>
+struct PoolDeleter {
+  PoolDeleter() noexcept = default;
+  void operator()(T* ptr) {
+    ptr->~T();
+    ObjectPool::release(ptr);
+  }
+};
+
+namespace object_pool {
+template <typename T, typename P, typename... Args>
+T* construct(P& pool, Args&&... args) {
+  static_assert(alignof(T) <= ObjectPool::BlockAlignment, "Over-aligned types are not supported");
+  auto block = pool.allocate(sizeof(T));
+  try {
+    return new (block) T(std::forward<Args>(args)...);
+  } catch (...) {
+    ObjectPool::release(block);
+    throw;
+  }
+}
+} // namespace object_pool
+
+template <typename T, ObjectPoolTarget P, typename... Args>
+UniquePointer<T, PoolDeleter<T>> make_ptr(P& pool, Args&&... args) {
+  return {TagCountedAllocation{}, object_pool::construct<T>(pool, std::forward<Args>(args)...)};
+}
+
+template <typename T, ObjectPoolTarget P, typename... Args>
+ShareablePointer<T, PoolDeleter<T>> make_shareable(P& pool, Args&&... args) {
+  return {object_pool::construct<RefCountedValue<T>>(pool, std::forward<Args>(args)...)};
+}
+
+template <typename T, ObjectPoolTarget P, typename... Args>
+ShareableMutablePointer<T, PoolDeleter<T>> make_mutable_shareable(P& pool, Args&&... args) {
+  return {object_pool::construct<RefCountedValue<T>>(pool, std::forward<Args>(args)...)};
+}
+
+template <typename T, ObjectPoolTarget P, typename... Args>
+ShareablePointer<T, PoolDeleter<T>, RefCounting::Atomic> make_atomic_shareable(P& pool, Args&&... args) {
+  return {object_pool::construct<RefCountedValue<T, RefCounting::Atomic>>(pool, std::forward<Args>(args)...)};
+}
+
+template <typename T, ObjectPoolTarget P, typename... Args>
+ShareableMutablePointer<T, PoolDeleter<T>, RefCounting::Atomic> make_atomic_mutable_shareable(P& pool,
+                                                                                                Args&&... args) {
+  return {object_pool::construct<RefCountedValue<T, RefCounting::Atomic>>(pool, std::forward<Args>(args)...)};
+}
+
+} // namespace kl
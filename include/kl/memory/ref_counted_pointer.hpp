@@ -1,33 +1,130 @@
 #pragma once
+#include <kl/except.hpp>
+#include <kl/memory/allocation_stats.hpp>
 #include <kl/memory/deleters.hpp>
+#include <kl/memory/relocation.hpp>
 #include <kl/inttypes.hpp>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
 
 namespace kl {
 
-template <typename T>
+// How the pointers below count their references. Local counts are plain integers, for objects that stay on one
+// thread; Atomic counts let copies of a pointer be made and dropped on any threads.
+enum class RefCounting { Local, Atomic };
+
+template <typename I, RefCounting Counting>
+using RefCount = std::conditional_t<Counting == RefCounting::Atomic, std::atomic<I>, I>;
+
+template <typename I>
+constexpr void add_ref_count(I& count) noexcept {
+  count++;
+}
+template <typename I>
+void add_ref_count(std::atomic<I>& count) noexcept {
+  // a new reference is made from an existing one, which keeps the object alive: no ordering is needed
+  count.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Drops a reference; false when it was the last one.
+template <typename I>
+constexpr bool remove_ref_count(I& count) noexcept {
+  count--;
+  return count > 0;
+}
+// Adds a reference unless the count already dropped to zero; false then.
+template <typename I>
+constexpr bool add_ref_count_if_alive(I& count) noexcept {
+  if (count <= 0) {
+    return false;
+  }
+  count++;
+  return true;
+}
+template <typename I>
+bool add_ref_count_if_alive(std::atomic<I>& count) noexcept {
+  auto current = count.load(std::memory_order_relaxed);
+  while (current > 0) {
+    if (count.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename I>
+bool remove_ref_count(std::atomic<I>& count) noexcept {
+  // the releases make every owner's writes visible to the one destroying the object, which acquires them
+  if (count.fetch_sub(1, std::memory_order_release) > 1) {
+    return true;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return false;
+}
+
+/**
+ * @brief A value with its reference counts, as allocated for the shareable pointers.
+ *
+ * The value is destroyed when the last strong reference - a shareable pointer - goes away, while the block itself is
+ * freed when the weak references go away too. The strong references together hold one weak reference, so the weak
+ * count only reaches zero once the value is gone. The block is freed by the pointers' Deleter, rebound to the block
+ * type, so DefaultDeleter deletes it and PoolDeleter returns it to its ObjectPool.
+ */
+template <typename T, RefCounting Counting = RefCounting::Local>
 struct RefCountedValue {
-  TSize reference_count = 0;
-  T value;
+  RefCount<TSize, Counting> reference_count = 0;
+  RefCount<TSize, Counting> weak_count = 1;
+  union {
+    T value;
+  };
+
+  // The value follows the counts, at the first offset aligned for T.
+  static constexpr size_t ValueOffset = (2 * sizeof(reference_count) + alignof(T) - 1) / alignof(T) * alignof(T);
 
   template <typename... Args>
-  constexpr RefCountedValue(Args&&... args) : value(std::forward<Args>(args)...) {}
+  constexpr RefCountedValue(Args&&... args) : value(std::forward<Args>(args)...) {
+    track_allocation(AllocationCategory::Pointer, sizeof(RefCountedValue));
+  }
+  // The value is destroyed by remove_ref() only.
+  constexpr ~RefCountedValue() {}
+
   constexpr T* value_address() noexcept { return &value; }
-  constexpr void add_new_ref() noexcept { reference_count++; }
-  constexpr bool remove_and_check_alive() noexcept {
-    reference_count--;
-    return reference_count > 0;
+  constexpr void add_new_ref() noexcept { add_ref_count(reference_count); }
+  constexpr bool remove_and_check_alive() noexcept { return remove_ref_count(reference_count); }
+  static constexpr RefCountedValue* from_pointer(T* ptr) noexcept {
+    return reinterpret_cast<RefCountedValue*>(reinterpret_cast<TByte*>(ptr) - ValueOffset);
   }
-  static constexpr RefCountedValue<T>* from_pointer(T* ptr) noexcept {
-    return reinterpret_cast<RefCountedValue<T>*>(reinterpret_cast<TByte*>(ptr) - sizeof(TSize));
+
+  template <typename Deleter>
+  static constexpr void remove_ref(RefCountedValue* counted) noexcept {
+    if (!counted->remove_and_check_alive()) {
+      counted->value.~T();
+      remove_weak_ref<Deleter>(counted);
+    }
+  }
+  template <typename Deleter>
+  static constexpr void remove_weak_ref(RefCountedValue* counted) noexcept {
+    if (!remove_ref_count(counted->weak_count)) {
+      track_release(AllocationCategory::Pointer, sizeof(RefCountedValue));
+      typename RebindDeleter<Deleter, RefCountedValue>::type()(counted);
+    }
   }
 };
 
-template <typename T, typename Deleter = DefaultDeleter<T>>
+template <typename T, typename Deleter = DefaultDeleter<T>, RefCounting Counting = RefCounting::Local>
+class WeakPointer;
+
+template <typename T, typename Deleter = DefaultDeleter<T>, RefCounting Counting = RefCounting::Local>
 class ShareableMutablePointer {
+  using Counted = RefCountedValue<T, Counting>;
+  friend class WeakPointer<T, Deleter, Counting>;
+
   T* m_ptr;
 
 public:
-  constexpr ShareableMutablePointer(RefCountedValue<T>* ptr) : m_ptr(ptr != nullptr ? ptr->value_address() : nullptr) {
+  constexpr ShareableMutablePointer(Counted* ptr) : m_ptr(ptr != nullptr ? ptr->value_address() : nullptr) {
     if (ptr) {
       ptr->add_new_ref();
     }
@@ -35,34 +132,31 @@ public:
 
   constexpr ShareableMutablePointer(const ShareableMutablePointer& val) noexcept : m_ptr(val.m_ptr) {
     if (m_ptr) {
-      RefCountedValue<T>::from_pointer(m_ptr)->add_new_ref();
+      Counted::from_pointer(m_ptr)->add_new_ref();
     }
   }
   constexpr ShareableMutablePointer(ShareableMutablePointer&& val) noexcept : m_ptr(val.m_ptr) { val.m_ptr = nullptr; }
   constexpr ShareableMutablePointer& operator=(const ShareableMutablePointer& val) noexcept {
-    if (&val != this) {
-      reset();
-      m_ptr = val.m_ptr;
-      if (m_ptr) {
-        RefCountedValue<T>::from_pointer(m_ptr)->add_new_ref();
-      }
-    }
+    // the new reference comes first, in case val is owned by the value this pointer releases
+    ShareableMutablePointer copy(val);
+    std::swap(m_ptr, copy.m_ptr);
     return *this;
   }
   constexpr ShareableMutablePointer& operator=(ShareableMutablePointer&& val) noexcept {
-    reset();
-    m_ptr = val.m_ptr;
-    val.m_ptr = nullptr;
+    if (&val != this) {
+      // val is emptied before the release, which can destroy the value owning val
+      auto old = std::exchange(m_ptr, std::exchange(val.m_ptr, nullptr));
+      if (old) {
+        Counted::template remove_ref<Deleter>(Counted::from_pointer(old));
+      }
+    }
     return *this;
   }
   constexpr ~ShareableMutablePointer() noexcept { reset(); }
 
   constexpr void reset() noexcept {
     if (m_ptr) {
-      auto ref_counted = RefCountedValue<T>::from_pointer(m_ptr);
-      if (!ref_counted->remove_and_check_alive()) {
-        delete ref_counted;
-      }
+      Counted::template remove_ref<Deleter>(Counted::from_pointer(m_ptr));
       m_ptr = nullptr;
     }
   }
@@ -86,21 +180,29 @@ constexpr ShareableMutablePointer<T> make_mutable_shareable(Args&&... args) {
   return ShareableMutablePointer<T>(new RefCountedValue<T>(std::forward<Args>(args)...));
 }
 
-template <typename T, typename Deleter = DefaultDeleter<T>>
+template <typename T>
+using AtomicShareableMutablePointer = ShareableMutablePointer<T, DefaultDeleter<T>, RefCounting::Atomic>;
+
+template <typename T, typename... Args>
+AtomicShareableMutablePointer<T> make_atomic_mutable_shareable(Args&&... args) {
+  return AtomicShareableMutablePointer<T>(new RefCountedValue<T, RefCounting::Atomic>(std::forward<Args>(args)...));
+}
+
+template <typename T, typename Deleter = DefaultDeleter<T>, RefCounting Counting = RefCounting::Local>
 class ShareablePointer {
-  RefCountedValue<T>* m_ptr;
+  friend class WeakPointer<T, Deleter, Counting>;
+
+  RefCountedValue<T, Counting>* m_ptr;
 
 public:
-  constexpr ShareablePointer(RefCountedValue<T>* ptr) : m_ptr(ptr) { m_ptr->add_new_ref(); }
+  constexpr ShareablePointer(RefCountedValue<T, Counting>* ptr) : m_ptr(ptr) { m_ptr->add_new_ref(); }
 
   constexpr ShareablePointer(const ShareablePointer& val) noexcept : m_ptr(val.m_ptr) { m_ptr->add_new_ref(); }
   constexpr ShareablePointer(ShareablePointer&& val) = delete;
   constexpr ShareablePointer& operator=(const ShareablePointer& val) = delete;
   constexpr ShareablePointer& operator=(ShareablePointer&& val) = delete;
   constexpr ~ShareablePointer() noexcept {
-    if (!m_ptr->remove_and_check_alive()) {
-      delete m_ptr;
-    }
+    RefCountedValue<T, Counting>::template remove_ref<Deleter>(m_ptr);
     m_ptr = nullptr;
   }
 
@@ -113,38 +215,113 @@ constexpr ShareablePointer<T> make_shareable(Args&&... args) {
   return ShareablePointer<T>(new RefCountedValue<T>(std::forward<Args>(args)...));
 }
 
+template <typename T>
+using AtomicShareablePointer = ShareablePointer<T, DefaultDeleter<T>, RefCounting::Atomic>;
+
+template <typename T, typename... Args>
+AtomicShareablePointer<T> make_atomic_shareable(Args&&... args) {
+  return AtomicShareablePointer<T>(new RefCountedValue<T, RefCounting::Atomic>(std::forward<Args>(args)...));
+}
+
+/**
+ * @brief A reference to the value of shareable pointers that does not keep the value alive.
+ *
+ * lock() returns a pointer to the value while any shareable pointer to it remains, and a null one afterwards. Until the
+ * last weak pointer goes away, the value's memory stays allocated, though the value itself was destroyed.
+ */
+template <typename T, typename Deleter, RefCounting Counting>
+class WeakPointer {
+  using Counted = RefCountedValue<T, Counting>;
+  Counted* m_ptr = nullptr;
+
+  constexpr void acquire(Counted* ptr) noexcept {
+    m_ptr = ptr;
+    if (m_ptr) {
+      add_ref_count(m_ptr->weak_count);
+    }
+  }
+
+public:
+  constexpr WeakPointer() = default;
+  constexpr WeakPointer(const ShareableMutablePointer<T, Deleter, Counting>& ptr) noexcept {
+    acquire(ptr.m_ptr != nullptr ? Counted::from_pointer(ptr.m_ptr) : nullptr);
+  }
+  constexpr WeakPointer(const ShareablePointer<T, Deleter, Counting>& ptr) noexcept {
+    acquire(ptr.m_ptr);
+  }
+  constexpr WeakPointer(const WeakPointer& val) noexcept { acquire(val.m_ptr); }
+  constexpr WeakPointer(WeakPointer&& val) noexcept : m_ptr(std::exchange(val.m_ptr, nullptr)) {}
+  constexpr WeakPointer& operator=(const WeakPointer& val) noexcept {
+    if (&val != this) {
+      reset();
+      acquire(val.m_ptr);
+    }
+    return *this;
+  }
+  constexpr WeakPointer& operator=(WeakPointer&& val) noexcept {
+    if (&val != this) {
+      reset();
+      m_ptr = std::exchange(val.m_ptr, nullptr);
+    }
+    return *this;
+  }
+  constexpr ~WeakPointer() noexcept { reset(); }
+
+  constexpr void reset() noexcept {
+    if (m_ptr) {
+      Counted::template remove_weak_ref<Deleter>(std::exchange(m_ptr, nullptr));
+    }
+  }
+
+  // A pointer sharing the value, or a null one if the value is gone.
+  constexpr ShareableMutablePointer<T, Deleter, Counting> lock() const noexcept {
+    ShareableMutablePointer<T, Deleter, Counting> result(nullptr);
+    if (m_ptr && add_ref_count_if_alive(m_ptr->reference_count)) {
+      result.m_ptr = m_ptr->value_address();
+    }
+    return result;
+  }
+  // Whether the value is gone; with atomic counts, a false answer can be outdated right away.
+  constexpr bool expired() const noexcept {
+    return m_ptr == nullptr || m_ptr->reference_count <= 0;
+  }
+};
+
+template <typename T>
+using AtomicWeakPointer = WeakPointer<T, DefaultDeleter<T>, RefCounting::Atomic>;
+
+template <RefCounting Counting = RefCounting::Local>
 struct RefCountedBase {
-  int64_t reference_count = 0;
+  RefCount<int64_t, Counting> reference_count = 0;
 
   template <typename T>
   constexpr T* start_address() noexcept {
     return reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(this) + sizeof(RefCountedBase));
   }
-  constexpr void add_new_ref() noexcept { reference_count++; }
-  constexpr bool remove_and_check_alive() noexcept {
-    reference_count--;
-    return reference_count > 0; // maybe this could be optimized by have a size_t and checking against 0;
-  }
+  constexpr void add_new_ref() noexcept { add_ref_count(reference_count); }
+  constexpr bool remove_and_check_alive() noexcept { return remove_ref_count(reference_count); }
 };
 
 enum class InitializationType { Constructor, None };
 
-template <typename T>
+template <typename T, RefCounting Counting = RefCounting::Local>
 class SharedArrayPointer {
-  RefCountedBase* m_ptr;
+  using Counted = RefCountedBase<Counting>;
+  Counted* m_ptr;
   int64_t m_size;
 
 public:
   constexpr SharedArrayPointer(int64_t size, InitializationType init_type = InitializationType::Constructor)
       : m_size(size) {
     if (size > 0) {
-      m_ptr = reinterpret_cast<RefCountedBase*>(new TByte[sizeof(RefCountedBase) + m_size * sizeof(T)]);
+      m_ptr = new (new TByte[sizeof(Counted) + m_size * sizeof(T)]) Counted();
+      track_allocation(AllocationCategory::Pointer, sizeof(Counted) + m_size * sizeof(T));
       if (init_type == InitializationType::Constructor) {
         for (int i = 0; i < m_size; i++) {
-          new (m_ptr->start_address<T>() + i) T();
+          new (m_ptr->template start_address<T>() + i) T();
         }
       }
-      m_ptr->reference_count = 1;
+      m_ptr->add_new_ref();
     } else {
       m_ptr = nullptr;
       m_size = 0;
@@ -162,22 +339,17 @@ public:
   }
 
   constexpr SharedArrayPointer& operator=(const SharedArrayPointer& val) noexcept {
-    if (&val != this) {
-      reset();
-      m_ptr = val.m_ptr;
-      m_size = val.m_size;
-      if (m_ptr) {
-        m_ptr->add_new_ref();
-      }
-    }
+    // the new reference comes first, in case val is owned by an item of the array this pointer releases
+    SharedArrayPointer copy(val);
+    std::swap(m_ptr, copy.m_ptr);
+    std::swap(m_size, copy.m_size);
     return *this;
   }
   constexpr SharedArrayPointer& operator=(SharedArrayPointer&& val) noexcept {
-    reset();
-    m_ptr = val.m_ptr;
-    m_size = val.m_size;
-    val.m_ptr = nullptr;
-    val.m_size = 0;
+    // val is emptied before the release, which can destroy the item owning val
+    SharedArrayPointer taken(std::move(val));
+    std::swap(m_ptr, taken.m_ptr);
+    std::swap(m_size, taken.m_size);
     return *this;
   }
   constexpr SharedArrayPointer& operator=(nullptr_t) noexcept {
@@ -190,9 +362,11 @@ public:
     if (m_ptr) {
       if (!m_ptr->remove_and_check_alive()) {
         for (int64_t i = 0; i < m_size; i++) {
-          (m_ptr->start_address<T>() + i)->~T();
+          (m_ptr->template start_address<T>() + i)->~T();
         }
+        m_ptr->~Counted();
         delete[] (reinterpret_cast<TByte*>(m_ptr));
+        track_release(AllocationCategory::Pointer, sizeof(Counted) + m_size * sizeof(T));
       }
       m_ptr = nullptr;
       m_size = 0;
@@ -201,7 +375,7 @@ public:
 
   constexpr T* get() const {
     if (m_ptr) {
-      return m_ptr->start_address<T>();
+      return m_ptr->template start_address<T>();
     }
     return nullptr;
   }
@@ -216,8 +390,20 @@ public:
     if (index >= m_size || index < 0) [[unlikely]] {
       throw Exception("Out of range");
     }
-    return m_ptr->start_address<T>()[index];
+    return m_ptr->template start_address<T>()[index];
   }
 };
 
+template <typename T>
+using AtomicSharedArrayPointer = SharedArrayPointer<T, RefCounting::Atomic>;
+
+template <typename T, typename Deleter, RefCounting Counting>
+struct TriviallyRelocatable<ShareableMutablePointer<T, Deleter, Counting>> : std::true_type {};
+template <typename T, typename Deleter, RefCounting Counting>
+struct TriviallyRelocatable<ShareablePointer<T, Deleter, Counting>> : std::true_type {};
+template <typename T, RefCounting Counting>
+struct TriviallyRelocatable<SharedArrayPointer<T, Counting>> : std::true_type {};
+template <typename T, typename Deleter, RefCounting Counting>
+struct TriviallyRelocatable<WeakPointer<T, Deleter, Counting>> : std::true_type {};
+
 } // namespace kl
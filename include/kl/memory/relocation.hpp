@@ -0,0 +1,27 @@
+#pragma once
+
+#include <type_traits>
+
+namespace kl {
+
+/**
+ * @brief Whether moving a T to a new address and destroying the original can be done by copying its bytes.
+ *
+ * True for trivially copyable types. Types that own resources through pointers to elsewhere - not to themselves -
+ * can opt in by specializing the trait, as kl does for Text and its smart pointers:
+ *
+ * @code
+ * template <>
+ * struct kl::TriviallyRelocatable<MyHandle> : std::true_type {};
+ * @endcode
+ *
+ * Containers use it to move their items with memcpy/memmove when they grow or shift, instead of a move constructor
+ * and a destructor call per item.
+ */
+template <typename T>
+struct TriviallyRelocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+template <typename T>
+constexpr bool is_trivially_relocatable = TriviallyRelocatable<std::remove_cv_t<T>>::value;
+
+} // namespace kl
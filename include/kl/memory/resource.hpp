@@ -0,0 +1,58 @@
+#pragma once
+#include <kl/memory/blocks.hpp>
+#include <concepts>
+#include <cstddef>
+
+// Memory resources hand raw storage to kl containers. A resource is a small value - usually empty, or a pointer to
+// the allocator doing the work - that the container keeps next to its data and uses for every allocation it makes.
+// Blocks are requested with their size and given back with the same size, are never empty, and must be aligned for
+// any type up to std::max_align_t.
+namespace kl {
+
+template <typename R>
+concept MemoryResource = requires(R& resource, void* block, size_t bytes) {
+  { resource.allocate(bytes) } -> std::same_as<void*>;
+  resource.release(block, bytes);
+};
+
+// A resource that can also enlarge a block, preserving its first `bytes` bytes, possibly at another address.
+// Containers of relocatable items grow through it instead of allocating, copying and releasing.
+template <typename R>
+concept GrowableMemoryResource = MemoryResource<R> && requires(R& resource, void* block, size_t bytes) {
+  { resource.grow(block, bytes, bytes) } -> std::same_as<void*>;
+};
+
+// The resource kl containers use unless told otherwise: the growable blocks of blocks.hpp. It has no state, so it
+// takes no room in the containers.
+struct DefaultResource {
+  void* allocate(size_t bytes) { return allocate_block(bytes); }
+  void* grow(void* block, size_t bytes, size_t new_bytes) { return grow_block(block, bytes, new_bytes); }
+  void release(void* block, size_t bytes) { release_block(block, bytes); }
+};
+
+/**
+ * @brief Base class for resources selected at runtime.
+ *
+ * Text buffers, which are not parameterized on a resource, are allocated from a DynamicResource (see
+ * TextResourceScope). Containers can use one through a ResourceRef.
+ */
+class DynamicResource {
+public:
+  virtual ~DynamicResource() = default;
+  virtual void* allocate(size_t bytes) = 0;
+  virtual void release(void* block, size_t bytes) = 0;
+};
+
+// A MemoryResource that forwards to a DynamicResource, which must outlive the containers using it.
+class ResourceRef {
+  DynamicResource* m_resource;
+
+public:
+  ResourceRef(DynamicResource& resource) : m_resource(&resource) {}
+
+  void* allocate(size_t bytes) { return m_resource->allocate(bytes); }
+  void release(void* block, size_t bytes) { m_resource->release(block, bytes); }
+  DynamicResource& get() const { return *m_resource; }
+};
+
+} // namespace kl
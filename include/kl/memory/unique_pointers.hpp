@@ -1,8 +1,11 @@
 #pragma once
 
 #include <kl/except.hpp>
+#include <kl/memory/allocation_stats.hpp>
 #include <kl/memory/deleters.hpp>
+#include <kl/memory/relocation.hpp>
 #include <kl/inttypes.hpp>
+#include <utility>
 
 namespace kl {
 
@@ -17,16 +20,41 @@ namespace kl {
 template <typename T, class Deleter = DefaultDeleter<T>>
 class UniquePointer {
   T* m_ptr = nullptr;
+#ifdef KL_ALLOCATION_STATS
+  // Whether the object was counted as allocated, by make_ptr.
+  bool m_counted = false;
+#endif
+
+  constexpr void take_counted([[maybe_unused]] UniquePointer& ptr) noexcept {
+#ifdef KL_ALLOCATION_STATS
+    m_counted = std::exchange(ptr.m_counted, false);
+#endif
+  }
+  constexpr void count_release() noexcept {
+#ifdef KL_ALLOCATION_STATS
+    if (std::exchange(m_counted, false)) {
+      track_release(AllocationCategory::Pointer, sizeof(T));
+    }
+#endif
+  }
 
 public:
   constexpr UniquePointer(T* ptr = nullptr) noexcept : m_ptr(ptr) {}
-  constexpr UniquePointer(UniquePointer&& ptr) noexcept { m_ptr = ptr.release(); }
+  constexpr UniquePointer(TagCountedAllocation, T* ptr) noexcept : m_ptr(ptr) {
+#ifdef KL_ALLOCATION_STATS
+    m_counted = true;
+#endif
+    track_allocation(AllocationCategory::Pointer, sizeof(T));
+  }
+  constexpr UniquePointer(UniquePointer&& ptr) noexcept : m_ptr(std::exchange(ptr.m_ptr, nullptr)) {
+    take_counted(ptr);
+  }
   UniquePointer(const UniquePointer& ptr) = delete;
   constexpr UniquePointer& operator=(UniquePointer&& ptr) {
     if (this != &ptr) {
       reset();
-      m_ptr = ptr.m_ptr;
-      ptr.m_ptr = nullptr;
+      m_ptr = std::exchange(ptr.m_ptr, nullptr);
+      take_counted(ptr);
     }
     return *this;
   }
@@ -54,13 +82,13 @@ public:
 
   constexpr T* get() const { return m_ptr; }
   constexpr T* release() {
-    auto ptr = m_ptr;
-    m_ptr = nullptr;
-    return ptr;
+    count_release();
+    return std::exchange(m_ptr, nullptr);
   }
 
   constexpr void reset() noexcept {
     if (m_ptr != nullptr) [[likely]] {
+      count_release();
       Deleter()(m_ptr);
       m_ptr = nullptr;
     }
@@ -71,20 +99,45 @@ template <typename T, class Deleter = DefaultMultiDeleter<T>>
 class UniqueArrayPointer {
   T* m_ptr = nullptr;
   TSize m_size = 0;
+#ifdef KL_ALLOCATION_STATS
+  // Whether the items were counted as allocated, by make_array_ptr.
+  bool m_counted = false;
+#endif
+
+  constexpr void take_counted([[maybe_unused]] UniqueArrayPointer& ptr) noexcept {
+#ifdef KL_ALLOCATION_STATS
+    m_counted = std::exchange(ptr.m_counted, false);
+#endif
+  }
+  constexpr void count_release() noexcept {
+#ifdef KL_ALLOCATION_STATS
+    if (std::exchange(m_counted, false)) {
+      track_release(AllocationCategory::Pointer, m_size * sizeof(T));
+    }
+#endif
+  }
 
 public:
   constexpr UniqueArrayPointer() noexcept = default;
   constexpr UniqueArrayPointer(T* ptr, TSize size) : m_ptr(ptr), m_size(std::max(size, 0)) {}
+  constexpr UniqueArrayPointer(TagCountedAllocation, T* ptr, TSize size) : UniqueArrayPointer(ptr, size) {
+#ifdef KL_ALLOCATION_STATS
+    m_counted = true;
+#endif
+    track_allocation(AllocationCategory::Pointer, m_size * sizeof(T));
+  }
   constexpr UniqueArrayPointer(UniqueArrayPointer&& ptr) {
-    m_size = ptr.m_size;
-    m_ptr = ptr.release();
+    m_size = std::exchange(ptr.m_size, 0);
+    m_ptr = std::exchange(ptr.m_ptr, nullptr);
+    take_counted(ptr);
   }
   UniqueArrayPointer(const UniqueArrayPointer& ptr) = delete;
   constexpr UniqueArrayPointer& operator=(UniqueArrayPointer&& ptr) {
     if (this != &ptr) {
       reset();
-      m_size = ptr.m_size;
-      m_ptr = ptr.release();
+      m_size = std::exchange(ptr.m_size, 0);
+      m_ptr = std::exchange(ptr.m_ptr, nullptr);
+      take_counted(ptr);
     }
     return *this;
   }
@@ -118,14 +171,14 @@ public:
   constexpr T* get() const { return m_ptr; }
   size_t size() const { return m_size; }
   constexpr T* release() {
-    auto ptr = m_ptr;
-    m_ptr = nullptr;
+    count_release();
     m_size = 0;
-    return ptr;
+    return std::exchange(m_ptr, nullptr);
   }
 
   constexpr void reset() {
     if (m_ptr != nullptr) [[likely]] {
+      count_release();
       Deleter()(m_ptr);
       m_ptr = nullptr;
       m_size = 0;
@@ -135,12 +188,17 @@ public:
 
 template <typename T, typename... Args>
 constexpr UniquePointer<T> make_ptr(Args&&... args) {
-  return UniquePointer<T>(new T(std::forward<Args>(args)...));
+  return UniquePointer<T>(TagCountedAllocation{}, new T(std::forward<Args>(args)...));
 }
 
 template <typename T>
 constexpr UniqueArrayPointer<T> make_array_ptr(size_t size) {
-  return UniqueArrayPointer<T>(new T[size], size);
+  return UniqueArrayPointer<T>(TagCountedAllocation{}, new T[size], size);
 }
 
+template <typename T, class Deleter>
+struct TriviallyRelocatable<UniquePointer<T, Deleter>> : std::true_type {};
+template <typename T, class Deleter>
+struct TriviallyRelocatable<UniqueArrayPointer<T, Deleter>> : std::true_type {};
+
 } // namespace kl
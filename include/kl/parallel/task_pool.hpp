@@ -0,0 +1,109 @@
+#pragma once
+#include <kl/inttypes.hpp>
+#include <kl/ds/array.hpp>
+#include <kl/ds/cursor.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+namespace kl {
+
+/**
+ * @brief Work-stealing thread pool for data-parallel loops.
+ *
+ * for_ranges() splits [0, size) into chunks of `grain` items and runs them on the workers and on the calling thread,
+ * returning once all of them are done. A task covering several chunks splits in half, keeping one half and queueing
+ * the other on the queue of its thread. Idle threads steal from the front of the other queues, where the largest
+ * pending halves are, so the load balances itself with few steals.
+ *
+ * A thread waiting for its loop runs other queued chunks in the meantime, so loops can be nested. The first
+ * exception thrown by a chunk is rethrown by for_ranges(), after the other chunks finish or are skipped.
+ */
+class TaskPool {
+  struct Job {
+    void (*run)(void* fn, Cursor begin, Cursor end);
+    void* fn;
+    TSize size;
+    TSize grain;
+    std::atomic<TSize> remaining;
+    std::atomic<bool> failed = false;
+    std::exception_ptr error;
+  };
+
+  // A range of chunks of a job.
+  struct Task {
+    Job* job;
+    TSize begin;
+    TSize end;
+  };
+
+  struct alignas(64) Queue {
+    std::mutex lock;
+    std::deque<Task> tasks;
+  };
+
+  // one queue per worker, and a last one shared by the threads calling into the pool
+  Queue* m_queues;
+  TSize m_queue_count;
+  Array<std::thread> m_workers;
+  std::atomic<TSize> m_pending = 0;
+  std::atomic<TSize> m_sleeping = 0;
+  std::atomic<bool> m_stopping = false;
+  std::mutex m_sleep_lock;
+  std::condition_variable m_wake;
+
+  template <typename Fn>
+  static void invoke(void* fn, Cursor begin, Cursor end) {
+    (*static_cast<Fn*>(fn))(begin, end);
+  }
+
+  TSize queue_index() const;
+  void push(TSize queue, Task task);
+  bool pop(TSize queue, Task& task);
+  void execute(TSize queue, Task task);
+  void work(TSize queue);
+  void run(Job& job);
+
+public:
+  // A pool with the given number of threads, the calling one included: threads - 1 workers are started.
+  explicit TaskPool(TSize threads = default_concurrency());
+  TaskPool(const TaskPool&) = delete;
+  TaskPool& operator=(const TaskPool&) = delete;
+  ~TaskPool();
+
+  static TSize default_concurrency();
+  // The pool used by default, with one thread per hardware thread.
+  static TaskPool& shared();
+
+  // Number of threads running the loops, the calling one included.
+  TSize concurrency() const { return m_queue_count; }
+
+  // Calls fn(Cursor begin, Cursor end) for each range [begin, end) of at most grain items that [0, size) splits
+  // into; the ranges start at multiples of grain.
+  template <typename Fn>
+  void for_ranges(TSize size, TSize grain, Fn&& fn) {
+    if (size <= 0) {
+      return;
+    }
+    grain = std::max(grain, TSize{1});
+    auto chunks = static_cast<TSize>((int64_t{size} + grain - 1) / grain);
+    if (chunks == 1 || m_queue_count == 1) {
+      for (TSize begin = 0; begin < size;) {
+        auto end = size - begin > grain ? begin + grain : size;
+        fn(Cursor(begin), Cursor(end));
+        begin = end;
+      }
+      return;
+    }
+    Job job{&invoke<std::remove_reference_t<Fn>>, const_cast<void*>(static_cast<const void*>(&fn)), size, grain,
+            chunks};
+    run(job);
+  }
+};
+
+} // namespace kl
@@ -1,13 +1,66 @@
 #pragma once
 #include <kl/inttypes.hpp>
+#include <kl/hash.hpp>
+#include <kl/text/utf8.hpp>
+#include <kl/ds/array.hpp>
+#include <kl/except.hpp>
+#include <kl/memory/allocation_stats.hpp>
+#include <kl/memory/resource.hpp>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <compare>
+#include <optional>
+#include <string_view>
+#include <utility>
 
 namespace kl {
 
 constexpr TSize RefCountedGuard{static_cast<TSize>(0xDEAD7C27)};
 
+// Local buffers use plain refcount updates and must stay on one thread; Shared buffers use atomic counts and can be
+// copied and released from any thread.
+enum class TextSharing { Local, Shared };
+
+// Scoped buffers come from the thread's TextResourceScope, when there is one; Heap buffers always come from the heap,
+// for copies that can outlive the scope, like interned texts.
+enum class TextAllocation { Scoped, Heap };
+
+/**
+ * @brief Routes the Text buffers allocated on this thread to a resource, for as long as the scope lives.
+ *
+ * Each buffer remembers its resource and goes back to it when its last reference is released, so the resource must
+ * outlive the texts, and be thread-safe if they are shared with other threads. Scopes nest; without one, buffers come
+ * from the heap. Copies that can outlive the scope, made by TextInternTable, shared() and the promotion of arena texts,
+ * always come from the heap.
+ */
+class TextResourceScope {
+  static inline thread_local DynamicResource* m_current = nullptr;
+  DynamicResource* m_previous;
+
+public:
+  explicit TextResourceScope(DynamicResource& resource) : m_previous(std::exchange(m_current, &resource)) {}
+  TextResourceScope(const TextResourceScope&) = delete;
+  TextResourceScope& operator=(const TextResourceScope&) = delete;
+  ~TextResourceScope() { m_current = m_previous; }
+
+  static DynamicResource* current() { return m_current; }
+};
+
 struct TextRefCountedBase {
+  static constexpr TSize SharedFlag = 1;
+  static constexpr TSize ArenaFlag = 2;
+  static constexpr TSize ResourceFlag = 4;
+
   TSize size = 0;
   TSize refcount = 1;
+  TSize flags = 0;
+  // UTF-8 state of the whole payload: zero when not checked yet, -1 when it is not well-formed, otherwise the number
+  // of code points plus one.
+  TSize utf8 = 0;
+  // Hash of the whole payload, filled the first time a Text covering all of it is hashed. Zero means not computed
+  // yet; literals get theirs at compile time.
+  uint64_t hash = 0;
 
   constexpr TextRefCountedBase() {
     if consteval {
@@ -15,12 +68,20 @@ struct TextRefCountedBase {
     }
   }
 
+  constexpr bool is_shared() const { return (flags & SharedFlag) != 0; }
+  constexpr bool is_arena() const { return (flags & ArenaFlag) != 0; }
+
   constexpr void add_ref() {
-    if (refcount != RefCountedGuard) {
+    if (is_shared()) {
+      std::atomic_ref(refcount).fetch_add(1, std::memory_order_relaxed);
+    } else if (refcount != RefCountedGuard) {
       refcount++;
     }
   }
   constexpr bool remove_ref_and_test() {
+    if (is_shared()) {
+      return std::atomic_ref(refcount).fetch_sub(1, std::memory_order_acq_rel) <= 1;
+    }
     if (refcount != RefCountedGuard) {
       refcount--;
       return refcount <= 0;
@@ -34,24 +95,52 @@ struct TextRefCountedBase {
   static constexpr TextRefCountedBase* from_text_address(char* ptr) {
     return reinterpret_cast<TextRefCountedBase*>(ptr - sizeof(TextRefCountedBase));
   }
-  static constexpr TextRefCountedBase* allocate(TSize payload_size) {
+  static constexpr TextRefCountedBase* allocate(TSize payload_size, TextSharing sharing = TextSharing::Local,
+                                                TextAllocation allocation = TextAllocation::Scoped) {
     if (payload_size < 0) {
       payload_size = 0;
     }
-    auto ptr = new char[sizeof(TextRefCountedBase) + payload_size];
-    auto base = reinterpret_cast<TextRefCountedBase*>(ptr);
+    TextRefCountedBase* base;
+    TSize flags = sharing == TextSharing::Shared ? SharedFlag : 0;
+    auto resource = allocation == TextAllocation::Scoped ? TextResourceScope::current() : nullptr;
+    if (resource != nullptr) [[unlikely]] {
+      base = allocate_from(*resource, payload_size);
+      flags |= ResourceFlag;
+    } else {
+      base = reinterpret_cast<TextRefCountedBase*>(new char[sizeof(TextRefCountedBase) + payload_size]);
+    }
+    track_allocation(AllocationCategory::Text, sizeof(TextRefCountedBase) + payload_size);
     base->size = payload_size;
     base->refcount = 1;
+    base->flags = flags;
+    base->utf8 = 0;
+    base->hash = 0;
     return base;
   }
 
   static constexpr void deallocate(TextRefCountedBase* ptr) {
     if (ptr->refcount != RefCountedGuard) {
-      delete[] reinterpret_cast<char*>(ptr);
+      track_release(AllocationCategory::Text, sizeof(TextRefCountedBase) + ptr->size);
+      if ((ptr->flags & ResourceFlag) != 0) [[unlikely]] {
+        release_to_resource(ptr);
+      } else {
+        delete[] reinterpret_cast<char*>(ptr);
+      }
     }
   }
+
+private:
+  // Resource buffers are preceded by a header recording where they came from.
+  static TextRefCountedBase* allocate_from(DynamicResource& resource, TSize payload_size);
+  static void release_to_resource(TextRefCountedBase* ptr);
 };
 
+class TextArena;
+class TextInternTable;
+
+enum class SplitEmpty { Keep, Discard };
+enum class SplitDirection { KeepLeft, Discard, KeepRight };
+
 template <TSize Size>
 struct TextLiteral {
   TextRefCountedBase base;
@@ -66,6 +155,9 @@ struct TextLiteral {
     for (TSize i = 0; i < Size; i++) { // compiler do your magic
       data[i] = literal[i];
     }
+    base.hash = hash_bytes(data, base.size);
+    auto code_points = utf8::count_valid(data, data + base.size);
+    base.utf8 = code_points < 0 ? -1 : code_points + 1;
   }
 };
 
@@ -74,45 +166,404 @@ constexpr TextRefCountedBase* operator""_tr() {
   return const_cast<TextRefCountedBase*>(&Item.base);
 }
 
+class Text;
+template <TextLiteral Item>
+constexpr Text operator""_t();
+
+// Runtime search entry points, implemented with the SIMD kernels selected for the running CPU.
+namespace text_search {
+const char* find_char(const char* begin, const char* end, char c);
+const char* find_last_char(const char* begin, const char* end, char c);
+TSize count_char(const char* begin, const char* end, char c);
+const char* find_first_not_of(const char* begin, const char* end, const char* set, TSize set_size);
+const char* find_last_not_of(const char* begin, const char* end, const char* set, TSize set_size);
+const char* find_text(const char* begin, const char* end, const char* needle, TSize needle_size);
+} // namespace text_search
+
+/**
+ * @brief Immutable text value.
+ *
+ * A Text either views a range of a reference counted buffer, or, for payloads of up to InlineCapacity bytes, keeps
+ * the characters inside the object itself (small-string mode), which saves the allocation and the refcount traffic.
+ * The last byte of the object holds the mode tag: in buffer mode it overlaps the most significant byte of m_end,
+ * which is never negative, so the high bit is free to mark the small-string mode.
+ *
+ * The query operations are constexpr. In constant evaluation the only texts are `_t` literals and their slices,
+ * which need no reference counting, and the searches run as plain loops instead of the SIMD kernels.
+ */
 class Text {
-  char* m_text_buffer = nullptr;
-  TSize m_start = 0;
-  TSize m_end = 0;
+  friend class TextInternTable;
+  template <TextLiteral Item>
+  friend constexpr Text operator""_t();
+
+  struct BufferRepr {
+    char* text_buffer;
+    TSize start;
+    TSize end;
+  };
+  static constexpr TSize InlineCapacity = sizeof(BufferRepr) - 1;
+  static constexpr TByte InlineTag = 0x80;
+  struct InlineRepr {
+    char data[InlineCapacity];
+    TByte tag;
+  };
+  union Repr {
+    BufferRepr buffer;
+    InlineRepr small;
+  };
+  static_assert(std::endian::native == std::endian::little, "The small-string tag overlaps the high byte of m_end");
+  static_assert(sizeof(Repr) == 16);
+
+  static constexpr TextLiteral<1> EmptyLiteral{""};
+  static constexpr std::string_view Whitespace{" \t\n\r"};
+
+  Repr m_repr{.buffer = empty_buffer()};
+
+  struct LiteralTag {};
+  // Views the characters of a literal; like any buffer, they are preceded by their (guarded) header.
+  constexpr Text(LiteralTag, const char* text, TSize size) : m_repr{.buffer = {const_cast<char*>(text), 0, size}} {}
+
+  constexpr bool is_inline() const {
+    if consteval {
+      return false; // small-string values are only created at runtime
+    } else {
+      return (m_repr.small.tag & InlineTag) != 0;
+    }
+  }
+
+  static constexpr BufferRepr empty_buffer() { return {const_cast<char*>(EmptyLiteral.data), 0, 0}; }
 
-  constexpr TextRefCountedBase* base() {
-    return reinterpret_cast<TextRefCountedBase*>(m_text_buffer - sizeof(TextRefCountedBase));
+  constexpr TextRefCountedBase* base() const {
+    return reinterpret_cast<TextRefCountedBase*>(m_repr.buffer.text_buffer - sizeof(TextRefCountedBase));
   }
 
-public:
-  constexpr Text() : Text(""_tr) {}
-  constexpr ~Text() {
-    if (m_text_buffer) {
-      auto ptr = base();
-      if (ptr->remove_ref_and_test()) {
-        TextRefCountedBase::deallocate(ptr);
+  // Whether this text views its whole buffer; such texts can use the values cached in the buffer header.
+  bool covers_buffer() const;
+  uint64_t cached_hash() const;
+  TSize buffer_utf8_state() const;
+  // Whether this text views a buffer known to be plain ASCII, so that any range of it is valid UTF-8 too.
+  bool in_ascii_buffer() const;
+
+  // Takes a reference on the buffer of a freshly copied representation.
+  void acquire();
+  void promote_arena_buffer();
+  Text(const char* ptr, TSize size, TextSharing sharing, TextAllocation allocation);
+  Text shared_slice(TSize start, TSize length) const;
+
+  // A view of [start, start + length) sharing this text's buffer. Arguments are expected to be in range.
+  constexpr Text slice(TSize start, TSize length) const {
+    if (length <= 0) {
+      return {};
+    }
+    if consteval {
+      auto text_start = m_repr.buffer.start + start;
+      return {LiteralTag{}, m_repr.buffer.text_buffer + text_start, length};
+    } else {
+      return shared_slice(start, length);
+    }
+  }
+
+  constexpr void release() {
+    if consteval {
+      return; // literals only
+    } else {
+      if (!is_inline()) {
+        auto ptr = base();
+        if (ptr->remove_ref_and_test()) {
+          TextRefCountedBase::deallocate(ptr);
+        }
       }
-      ptr = nullptr;
-      m_start = 0;
-      m_end = 0;
     }
   }
-  Text(const Text& value);
-  Text(Text&& dying) noexcept;
-  Text& operator=(const Text& value);
-  Text& operator=(Text&& dying) noexcept;
+
+  // Search primitives: plain loops in constant evaluation, the SIMD kernels at runtime.
+  static constexpr const char* find_char(const char* begin, const char* end, char c) {
+    if consteval {
+      for (; begin < end && *begin != c; begin++) {
+      }
+      return begin;
+    } else {
+      return text_search::find_char(begin, end, c);
+    }
+  }
+  static constexpr const char* find_last_char(const char* begin, const char* end, char c) {
+    if consteval {
+      for (auto p = end; p > begin; p--) {
+        if (*(p - 1) == c) {
+          return p - 1;
+        }
+      }
+      return end;
+    } else {
+      return text_search::find_last_char(begin, end, c);
+    }
+  }
+  static constexpr TSize count_char(const char* begin, const char* end, char c) {
+    if consteval {
+      TSize count = 0;
+      for (; begin < end; begin++) {
+        count += *begin == c ? 1 : 0;
+      }
+      return count;
+    } else {
+      return text_search::count_char(begin, end, c);
+    }
+  }
+  static constexpr bool in_set(char c, std::string_view set) {
+    for (auto item: set) {
+      if (item == c) {
+        return true;
+      }
+    }
+    return false;
+  }
+  static constexpr const char* find_first_not_of(const char* begin, const char* end, std::string_view set) {
+    if consteval {
+      for (; begin < end && in_set(*begin, set); begin++) {
+      }
+      return begin;
+    } else {
+      return text_search::find_first_not_of(begin, end, set.data(), static_cast<TSize>(set.size()));
+    }
+  }
+  static constexpr const char* find_last_not_of(const char* begin, const char* end, std::string_view set) {
+    if consteval {
+      for (auto p = end; p > begin; p--) {
+        if (!in_set(*(p - 1), set)) {
+          return p - 1;
+        }
+      }
+      return end;
+    } else {
+      return text_search::find_last_not_of(begin, end, set.data(), static_cast<TSize>(set.size()));
+    }
+  }
+  static constexpr const char* find_text(const char* begin, const char* end, const char* needle, TSize needle_size) {
+    if consteval {
+      for (auto p = begin; end - p >= needle_size; p++) {
+        TSize i = 0;
+        for (; i < needle_size && p[i] == needle[i]; i++) {
+        }
+        if (i == needle_size) {
+          return p;
+        }
+      }
+      return end;
+    } else {
+      return text_search::find_text(begin, end, needle, needle_size);
+    }
+  }
+
+public:
+  constexpr Text() = default;
+  constexpr ~Text() { release(); }
+  constexpr Text(const Text& value) : m_repr(value.m_repr) {
+    if !consteval {
+      acquire();
+    }
+  }
+  constexpr Text(Text&& dying) noexcept : m_repr(dying.m_repr) { dying.m_repr.buffer = empty_buffer(); }
+  constexpr Text& operator=(const Text& value) {
+    if (this != &value) {
+      *this = Text(value);
+    }
+    return *this;
+  }
+  constexpr Text& operator=(Text&& dying) noexcept {
+    if (this != &dying) {
+      release();
+      m_repr = dying.m_repr;
+      dying.m_repr.buffer = empty_buffer();
+    }
+    return *this;
+  }
 
   Text(char c);
   Text(const char* ptr);
   constexpr Text(std::nullptr_t) : Text() {}
   Text(const char* ptr, TSize size);
-  constexpr Text(TextRefCountedBase* ptr) : m_text_buffer(ptr->text_address()), m_start(0), m_end(ptr->size) {}
+  Text(const char* ptr, TSize size, TextSharing sharing);
+  Text(const char* ptr, TSize size, TextArena& arena);
+  constexpr Text(TextRefCountedBase* ptr) : m_repr{.buffer = {ptr->text_address(), 0, ptr->size}} {}
+
+  constexpr TSize size() const {
+    if (is_inline()) {
+      return m_repr.small.tag & ~InlineTag;
+    }
+    return m_repr.buffer.end - m_repr.buffer.start;
+  }
+  constexpr const char* begin() const {
+    if (is_inline()) {
+      return m_repr.small.data;
+    }
+    return m_repr.buffer.text_buffer + m_repr.buffer.start;
+  }
+  constexpr const char* end() const { return begin() + size(); }
+  constexpr std::string_view to_view() const { return {begin(), static_cast<size_t>(size())}; }
+
+  // A copy of this text that can be handed to other threads. Small texts and literals are always safe to share; a
+  // local buffer is switched to atomic counting when this is its only owner, otherwise its range is copied to the heap.
+  Text shared() const;
+  bool is_shared() const;
+
+  // hash_bytes() of the content. Texts that cover their whole buffer cache it in the buffer header.
+  constexpr uint64_t hash() const {
+    if consteval {
+      return hash_bytes(begin(), size());
+    } else {
+      return cached_hash();
+    }
+  }
+
+  // Whether the text is well-formed UTF-8. The result for a whole buffer is cached in its header.
+  bool is_valid_utf8() const;
+  // Number of code points; for malformed text, the number of bytes that are not continuation bytes.
+  TSize utf8_length() const;
+  // Like sublen, with start and len counted in code points.
+  Text utf8_sublen(TSize start, TSize len) const;
+
+  constexpr char operator[](TSize index) const {
+    auto text_size = size();
+    if (index < 0) {
+      index += text_size;
+    }
+    if (index >= text_size || index < 0) [[unlikely]] {
+      throw Exception("Out of range: {} out of {}", index, text_size);
+    }
+    return begin()[index];
+  }
+
+  constexpr bool operator==(const Text& value) const {
+    if (size() != value.size()) {
+      return false;
+    }
+    if !consteval {
+      if (begin() == value.begin()) {
+        return true;
+      }
+    }
+    return to_view() == value.to_view();
+  }
+  constexpr std::strong_ordering operator<=>(const Text& value) const { return to_view() <=> value.to_view(); }
 
-  constexpr TSize size() { return m_end - m_start; }
+  constexpr bool starts_with(char c) const { return size() > 0 && *begin() == c; }
+  constexpr bool starts_with(const Text& value) const { return to_view().starts_with(value.to_view()); }
+  constexpr bool ends_with(char c) const { return size() > 0 && *(end() - 1) == c; }
+  constexpr bool ends_with(const Text& value) const { return to_view().ends_with(value.to_view()); }
+
+  constexpr bool contains(char c) const { return pos(c).has_value(); }
+  // occurence is one based - so first occurence is 1;
+  constexpr std::optional<TSize> pos(char c, TSize occurence = 1) const {
+    if (occurence <= 0) {
+      return std::nullopt;
+    }
+    auto e = end();
+    for (auto p = begin(); p < e; p++) {
+      p = find_char(p, e, c);
+      if (p < e) {
+        occurence--;
+        if (occurence == 0) {
+          return static_cast<TSize>(p - begin());
+        }
+      }
+    }
+    return std::nullopt;
+  }
+  constexpr std::optional<TSize> pos(const Text& value, TSize occurence = 1) const {
+    if (occurence <= 0 || value.size() == 0) {
+      return std::nullopt;
+    }
+    auto e = end();
+    for (auto p = begin(); p < e; p += value.size()) {
+      p = find_text(p, e, value.begin(), value.size());
+      if (p == e) {
+        break;
+      }
+      occurence--;
+      if (occurence == 0) {
+        return static_cast<TSize>(p - begin());
+      }
+    }
+    return std::nullopt;
+  }
+  constexpr std::optional<TSize> last_pos(char c) const {
+    auto p = find_last_char(begin(), end(), c);
+    if (p == end()) {
+      return std::nullopt;
+    }
+    return static_cast<TSize>(p - begin());
+  }
+  // how many times the character c appears in the text
+  constexpr TSize count(char c) const { return count_char(begin(), end(), c); }
+
+  constexpr Text trim() const { return trim_left().trim_right(); }
+  constexpr Text trim_left() const { return skip(Whitespace); }
+  constexpr Text trim_right() const {
+    auto p = find_last_not_of(begin(), end(), Whitespace);
+    if (p == end()) {
+      return {};
+    }
+    return slice(0, static_cast<TSize>(p - begin()) + 1);
+  }
+  constexpr Text skip(std::string_view skippables) const {
+    return skip(static_cast<TSize>(find_first_not_of(begin(), end(), skippables) - begin()));
+  }
+  constexpr Text skip(TSize n) const {
+    auto text_size = size();
+    if (n < text_size) {
+      n = std::max(n, 0);
+      return slice(n, text_size - n);
+    }
+    return {};
+  }
+
+  // substring position based. The string will contain the character from ending position too.
+  constexpr Text subpos(TSize start, TSize end) const {
+    auto text_size = size();
+    if (start < 0 || start >= text_size || end < start) {
+      return {};
+    }
+    end = std::min(end + 1, text_size);
+    return slice(start, end - start);
+  }
+  // substring length based. The return value will have a string of at most <len> characters
+  constexpr Text sublen(TSize start, TSize len) const {
+    auto text_size = size();
+    if (start < 0 || start >= text_size) {
+      return {};
+    }
+    return slice(start, std::min(len, text_size - start));
+  }
+
+  constexpr std::pair<Text, Text> split_next_char(char c, SplitDirection direction = SplitDirection::Discard) const {
+    auto position = pos(c);
+    if (!position.has_value()) {
+      return {*this, {}};
+    }
+    auto split_position = *position;
+    if (direction == SplitDirection::Discard) {
+      return {slice(0, split_position), skip(split_position + 1)};
+    }
+    if (direction == SplitDirection::KeepLeft) {
+      split_position++;
+    }
+    return {slice(0, split_position), skip(split_position)};
+  }
+  Array<Text> split_by_char(char c, SplitEmpty on_empty = SplitEmpty::Discard) const;
 };
 
 template <TextLiteral Item>
 constexpr Text operator""_t() {
-  return Text(const_cast<TextRefCountedBase*>(&Item.base));
+  return Text(Text::LiteralTag{}, Item.data, Item.base.size);
 }
 
+// The inline representation holds no pointers into the object, so a Text can change address by a plain copy.
+template <>
+struct TriviallyRelocatable<Text> : std::true_type {};
+
 } // namespace kl
+
+template <>
+struct std::hash<kl::Text> {
+  std::size_t operator()(const kl::Text& value) const noexcept { return value.hash(); }
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <kl/text.hpp>
+
+namespace kl {
+
+/**
+ * @brief Monotonic bump allocator for request-scoped Text buffers.
+ *
+ * Buffers taken from an arena are not reference counted: they live until the arena is reset or destroyed. Moving an
+ * arena-backed Text keeps it in the arena, while copying it promotes the copy to a regular heap buffer, so copies can
+ * safely outlive the arena. Substrings obtained from an arena-backed Text view the same arena memory. As with any
+ * arena, the arena-backed texts themselves must be destroyed (or moved from) before the arena is reset.
+ */
+class TextArena {
+  struct Block {
+    Block* next;
+    TSize capacity;
+    TSize used;
+    constexpr char* data() { return reinterpret_cast<char*>(this) + sizeof(Block); }
+  };
+
+  Block* m_blocks = nullptr;
+  TSize m_block_size;
+
+  Block* add_block(TSize capacity);
+
+public:
+  static constexpr TSize DefaultBlockSize = 64 * 1024;
+
+  explicit TextArena(TSize block_size = DefaultBlockSize);
+  TextArena(const TextArena&) = delete;
+  TextArena(TextArena&&) = delete;
+  TextArena& operator=(const TextArena&) = delete;
+  TextArena& operator=(TextArena&&) = delete;
+  ~TextArena();
+
+  // Allocates a buffer header followed by payload_size bytes. The buffer is flagged as arena-owned.
+  TextRefCountedBase* allocate(TSize payload_size);
+  // Releases every buffer at once. One block is kept around to serve the next round of allocations.
+  void reset();
+  // Bytes handed out since the last reset, headers included.
+  TSize used_bytes() const;
+};
+
+} // namespace kl
@@ -0,0 +1,65 @@
+#pragma once
+#include <kl/text.hpp>
+#include <kl/ds/array.hpp>
+#include <initializer_list>
+#include <optional>
+
+namespace kl {
+
+/**
+ * @brief Text built incrementally out of segments.
+ *
+ * Appending only records the segment and its offset in the chain, so indexed access, substrings and searches find
+ * their segment with a binary search over the offsets instead of flattening the chain. Flattening (to_text, the Text
+ * conversion) copies the segments into a buffer that the chain keeps, with room to grow: flattening again after more
+ * segments were added only copies the new segments, so building a large output while flattening it along the way
+ * stays linear. The flattened texts share that buffer; the chain only ever writes past their end.
+ */
+class TextChain {
+  Array<Text> m_segments;
+  // m_offsets[i] is the position of m_segments[i] in the chain
+  Array<TSize> m_offsets;
+  TSize m_size = 0;
+
+  // Flattening buffer, owned through m_storage, with the first m_flat_segments segments already copied in.
+  mutable Text m_storage;
+  mutable TextRefCountedBase* m_storage_base = nullptr;
+  mutable TSize m_flat_segments = 0;
+
+  TSize segment_index(TSize position) const;
+  bool matches_at(TSize position, const Text& value) const;
+  void flatten() const;
+
+public:
+  TextChain() = default;
+  TextChain(std::initializer_list<Text> list);
+  TextChain(const Array<Text>& list);
+  // Copies share the segments but not the flattening buffer.
+  TextChain(const TextChain& value);
+  TextChain(TextChain&& dying) noexcept;
+  TextChain& operator=(const TextChain& value);
+  TextChain& operator=(TextChain&& dying) noexcept;
+  ~TextChain() = default;
+
+  void add(const Text& text);
+  void add(const TextChain& chain);
+  void operator+=(const Text& text);
+  void operator+=(const TextChain& chain);
+  void clear();
+
+  TSize size() const;
+  const Array<Text>& segments() const;
+
+  Text to_text() const;
+  operator Text() const;
+  Text join(char split_char = '\0') const;
+  Text join(const Text& split_text, const Text& prefix = {}, const Text& suffix = {}) const;
+
+  // Same semantics as the Text operations, without flattening the chain.
+  char operator[](TSize index) const;
+  Text sublen(TSize start, TSize len) const;
+  std::optional<TSize> pos(char c, TSize occurence = 1) const;
+  std::optional<TSize> pos(const Text& value, TSize occurence = 1) const;
+};
+
+} // namespace kl
@@ -0,0 +1,67 @@
+#pragma once
+#include <kl/text.hpp>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_set>
+
+namespace kl {
+
+// Strong tables keep every interned text alive; weak tables drop the entries nobody else holds any longer.
+enum class InternMode { Strong, Weak };
+
+/**
+ * @brief Interning table that maps each distinct content to one canonical Text.
+ *
+ * The canonical texts own an exact-size, atomically counted buffer (literals are kept as they are), so every value
+ * returned for the same content shares the same buffer and compares equal on buffer pointer and range alone. Small
+ * texts are returned unchanged: they live inside the Text object and compare as fast as a pointer would.
+ * The table is split into shards, each with its own lock, so that concurrent inserts rarely contend.
+ */
+class TextInternTable {
+  struct Hash {
+    using is_transparent = void;
+    size_t operator()(std::string_view value) const;
+    size_t operator()(const Text& value) const;
+  };
+  struct Equal {
+    using is_transparent = void;
+    bool operator()(const Text& left, const Text& right) const { return left == right; }
+    bool operator()(std::string_view left, const Text& right) const { return left == right.to_view(); }
+    bool operator()(const Text& left, std::string_view right) const { return left.to_view() == right; }
+  };
+  struct Shard {
+    std::mutex lock;
+    std::unordered_set<Text, Hash, Equal> texts;
+    size_t sweep_threshold = 0;
+  };
+
+  InternMode m_mode;
+  TSize m_shard_mask;
+  std::unique_ptr<Shard[]> m_shards;
+
+  Text intern(std::string_view value, const Text* source);
+  static void sweep(Shard& shard);
+  static bool table_only_reference(const Text& value);
+  static bool is_full_literal(const Text& value);
+  static bool is_small(std::string_view value);
+
+public:
+  static constexpr TSize DefaultShardCount = 64;
+
+  // The shard count is rounded up to a power of two.
+  explicit TextInternTable(InternMode mode = InternMode::Strong, TSize shard_count = DefaultShardCount);
+
+  Text intern(const Text& value);
+  Text intern(std::string_view value);
+
+  // Weak mode: drops the entries that only the table still references. Weak tables also sweep a shard on their own
+  // whenever it has doubled in size since its last sweep.
+  void sweep();
+  TSize size();
+};
+
+// Interns the value in the process-wide strong table.
+Text intern(const Text& value);
+
+} // namespace kl
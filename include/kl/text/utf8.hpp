@@ -0,0 +1,62 @@
+#pragma once
+#include <kl/inttypes.hpp>
+
+// Scalar UTF-8 helpers. They are usable in constant expressions, which lets literals carry their UTF-8 state; Text
+// itself uses vectorized kernels at runtime.
+namespace kl::utf8 {
+
+constexpr bool is_continuation(char c) { return (static_cast<TByte>(c) & 0xC0) == 0x80; }
+
+// Length of the well-formed sequence starting at p, or 0 when the bytes at p do not form one. Well-formed follows
+// RFC 3629: no overlong forms, no surrogates and nothing above U+10FFFF.
+constexpr TSize sequence_length(const char* p, const char* end) {
+  auto lead = static_cast<TByte>(p[0]);
+  if (lead < 0x80) {
+    return 1;
+  }
+  auto available = end - p;
+  auto continued = [p, available](TSize count) {
+    for (TSize i = 1; i <= count; i++) {
+      if (i >= available || !is_continuation(p[i])) {
+        return false;
+      }
+    }
+    return true;
+  };
+  if (lead < 0xC2) {
+    return 0;
+  }
+  if (lead < 0xE0) {
+    return continued(1) ? 2 : 0;
+  }
+  if (lead < 0xF0) {
+    if (!continued(2)) {
+      return 0;
+    }
+    auto second = static_cast<TByte>(p[1]);
+    return (lead == 0xE0 && second < 0xA0) || (lead == 0xED && second > 0x9F) ? 0 : 3;
+  }
+  if (lead < 0xF5) {
+    if (!continued(3)) {
+      return 0;
+    }
+    auto second = static_cast<TByte>(p[1]);
+    return (lead == 0xF0 && second < 0x90) || (lead == 0xF4 && second > 0x8F) ? 0 : 4;
+  }
+  return 0;
+}
+
+// Number of code points in [begin, end), or -1 when it is not well-formed UTF-8.
+constexpr TSize count_valid(const char* begin, const char* end) {
+  TSize count = 0;
+  for (auto p = begin; p < end; count++) {
+    auto length = sequence_length(p, end);
+    if (length == 0) {
+      return -1;
+    }
+    p += length;
+  }
+  return count;
+}
+
+} // namespace kl::utf8
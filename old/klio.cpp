@@ -1,5 +1,6 @@
 #include "klio.hpp"
 
+#include <kl/io/posix.hpp>
 #include <sys/stat.h>
 #include <sys/uio.h>
 #include <fcntl.h>
@@ -21,6 +22,7 @@ size_t Stream::read([[maybe_unused]] std::span<uint8_t> where) {
 void Stream::write([[maybe_unused]] std::span<uint8_t> what) {
   throw RuntimeError::OperationNotSupported("Stream::write", s_not_implemented);
 }
+void Stream::write(const TextChain& what) { write(what.to_text().to_raw_data()); }
 void Stream::seek([[maybe_unused]] size_t offset) {
   throw RuntimeError::OperationNotSupported("Stream::seek", s_not_implemented);
 }
@@ -97,7 +99,7 @@ void StreamWriter::write_line(const Text& what) {
   m_stream->write(what.to_raw_data());
   m_stream->write(std::span<uint8_t>(reinterpret_cast<uint8_t*>(const_cast<char*>(eol)), 1));
 }
-void StreamWriter::write(const TextChain& what) { m_stream->write(what.to_text().to_raw_data()); }
+void StreamWriter::write(const TextChain& what) { m_stream->write(what); }
 void StreamWriter::flush() { m_stream->flush(); }
 
 PosixFileStream::PosixFileStream(int fd) : m_fd(fd) {
@@ -171,6 +173,17 @@ void PosixFileStream::write(std::span<uint8_t> what) {
   }
 }
 
+void PosixFileStream::write(const TextChain& what) {
+  std::vector<iovec> parts;
+  parts.reserve(what.chain().size());
+  for (const auto& segment: what.chain()) {
+    if (segment.size() > 0) {
+      parts.push_back({.iov_base = const_cast<char*>(segment.begin()), .iov_len = segment.size()});
+    }
+  }
+  kl::posix::write_all(m_fd, parts);
+}
+
 void PosixFileStream::seek(size_t offset) {
   if (lseek(m_fd, static_cast<off_t>(offset), SEEK_SET) < 0) [[unlikely]] {
     throw RuntimeError::CurrentStandardIOError();
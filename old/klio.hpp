@@ -32,6 +32,8 @@ public: // properties
 public: // operations
   virtual size_t read(std::span<uint8_t> where);
   virtual void write(std::span<uint8_t> what);
+  // Writes the chain flattened into one buffer, with a single write; streams that can gather the segments override it.
+  virtual void write(const TextChain& what);
 
   virtual void seek(size_t offset);
   virtual bool data_available();
@@ -91,6 +93,8 @@ public: // properties
 public: // operations
   size_t read(std::span<uint8_t> where) override;
   void write(std::span<uint8_t> what) override;
+  // Gathers the segments without flattening them, with kl::posix::write_all.
+  void write(const TextChain& what) override;
 
   void seek(size_t offset) override;
   bool data_available() override;
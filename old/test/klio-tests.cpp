@@ -0,0 +1,32 @@
+#include <kl/klio.hpp>
+#include <gtest/gtest.h>
+#include <climits>
+#include <unistd.h>
+using namespace kl;
+using namespace kl::literals;
+
+TEST(klio, write_text_chain) {
+  char name[] = "/tmp/klio-tests-XXXXXX";
+  int fd = ::mkstemp(name);
+  ASSERT_GE(fd, 0);
+
+  TextChain tc;
+  std::string expected;
+  for (int i = 0; i < IOV_MAX * 2 + 17; i++) {
+    tc.add(Text(std::to_string(i)));
+    tc.add(""_t);
+    tc.add(","_t);
+    expected += std::to_string(i) + ",";
+  }
+  {
+    PosixFileStream stream(fd);
+    StreamWriter writer(&stream);
+    writer.write(tc);
+    EXPECT_EQ(stream.size(), expected.size());
+  }
+
+  FileStream input(Text(name), FileOpenMode::ReadOnly);
+  StreamReader reader(&input);
+  EXPECT_EQ(reader.read_all().to_view(), expected);
+  ::unlink(name);
+}
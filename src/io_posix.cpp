@@ -0,0 +1,34 @@
+#include "kl/io/posix.hpp"
+#include "kl/except.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <system_error>
+
+namespace kl::posix {
+
+void write_all(int fd, std::span<iovec> parts) {
+  auto part = parts.begin();
+  while (part != parts.end()) {
+    auto count = static_cast<int>(std::min<std::ptrdiff_t>(parts.end() - part, IOV_MAX));
+    auto bytes_written = ::writev(fd, &*part, count);
+    if (bytes_written < 0) [[unlikely]] {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw Exception("Write failed: {}", std::generic_category().message(errno));
+    }
+    // skip what was written; a partially written buffer is resumed from where the write stopped
+    auto written = static_cast<size_t>(bytes_written);
+    while (part != parts.end() && written >= part->iov_len) {
+      written -= part->iov_len;
+      ++part;
+    }
+    if (written > 0) {
+      part->iov_base = static_cast<char*>(part->iov_base) + written;
+      part->iov_len -= written;
+    }
+  }
+}
+
+} // namespace kl::posix
@@ -0,0 +1,56 @@
+#include "kl/memory/allocation_stats.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+
+namespace kl {
+
+namespace {
+struct Counters {
+  std::atomic<int64_t> live_bytes = 0;
+  std::atomic<int64_t> peak_bytes = 0;
+  std::atomic<int64_t> allocations = 0;
+  std::atomic<int64_t> releases = 0;
+  std::array<std::atomic<int64_t>, AllocationSizeBuckets> sizes{};
+};
+
+Counters counters[AllocationCategoryCount];
+
+Counters& counters_of(AllocationCategory category) { return counters[static_cast<TSize>(category)]; }
+} // namespace
+
+AllocationStats allocation_stats(AllocationCategory category) {
+  auto& from = counters_of(category);
+  AllocationStats stats{.live_bytes = from.live_bytes.load(std::memory_order_relaxed),
+                        .peak_bytes = from.peak_bytes.load(std::memory_order_relaxed),
+                        .allocations = from.allocations.load(std::memory_order_relaxed),
+                        .releases = from.releases.load(std::memory_order_relaxed)};
+  for (TSize i = 0; i < AllocationSizeBuckets; i++) {
+    stats.sizes[i] = from.sizes[i].load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+namespace allocation_tracking {
+
+void record_allocation(AllocationCategory category, size_t bytes) noexcept {
+  auto& to = counters_of(category);
+  auto bucket = std::min(std::max(static_cast<int>(std::bit_width(bytes)), 1) - 1, int{AllocationSizeBuckets} - 1);
+  to.sizes[bucket].fetch_add(1, std::memory_order_relaxed);
+  to.allocations.fetch_add(1, std::memory_order_relaxed);
+  auto live = to.live_bytes.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed) +
+              static_cast<int64_t>(bytes);
+  auto peak = to.peak_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !to.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+  }
+}
+
+void record_release(AllocationCategory category, size_t bytes) noexcept {
+  auto& to = counters_of(category);
+  to.releases.fetch_add(1, std::memory_order_relaxed);
+  to.live_bytes.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+}
+
+} // namespace allocation_tracking
+
+} // namespace kl
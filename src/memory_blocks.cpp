@@ -0,0 +1,114 @@
+#include "kl/memory/blocks.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#define KL_MAPPED_BLOCKS
+#endif
+
+namespace kl {
+
+namespace {
+
+#ifdef KL_MAPPED_BLOCKS
+constexpr size_t HugePageSize = 2 << 20;
+
+bool is_mapped(size_t bytes) { return bytes >= MappedBlockSize; }
+size_t mapped_size(size_t bytes) { return (bytes + HugePageSize - 1) & ~(HugePageSize - 1); }
+
+// Maps size bytes (a multiple of the huge page size) starting on a huge page boundary, so that transparent huge
+// pages can back the whole block.
+void* map_aligned(size_t size) {
+  auto raw = mmap(nullptr, size + HugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED) {
+    throw std::bad_alloc();
+  }
+  auto start = reinterpret_cast<uintptr_t>(raw);
+  auto aligned = (start + HugePageSize - 1) & ~(HugePageSize - 1);
+  if (aligned > start) {
+    munmap(raw, aligned - start);
+  }
+  munmap(reinterpret_cast<void*>(aligned + size), start + HugePageSize - aligned);
+  madvise(reinterpret_cast<void*>(aligned), size, MADV_HUGEPAGE);
+  return reinterpret_cast<void*>(aligned);
+}
+
+void* grow_mapped(void* block, size_t bytes, size_t new_bytes) {
+  auto size = mapped_size(bytes);
+  auto new_size = mapped_size(new_bytes);
+  if (new_size == size) {
+    return block;
+  }
+  // in place, when the addresses after the block are free
+  if (mremap(block, size, new_size, 0) != MAP_FAILED) {
+    madvise(static_cast<char*>(block) + size, new_size - size, MADV_HUGEPAGE);
+    return block;
+  }
+  // otherwise the pages move over a new aligned range, replacing its own
+  auto target = map_aligned(new_size);
+  auto moved = mremap(block, size, new_size, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+  if (moved == MAP_FAILED) {
+    munmap(target, new_size);
+    throw std::bad_alloc();
+  }
+  return moved;
+}
+#endif
+
+} // namespace
+
+void* allocate_block(size_t bytes) {
+  if (bytes == 0) {
+    return nullptr;
+  }
+#ifdef KL_MAPPED_BLOCKS
+  if (is_mapped(bytes)) {
+    return map_aligned(mapped_size(bytes));
+  }
+#endif
+  auto block = std::malloc(bytes);
+  if (block == nullptr) {
+    throw std::bad_alloc();
+  }
+  return block;
+}
+
+void* grow_block(void* block, size_t bytes, size_t new_bytes) {
+  if (block == nullptr) {
+    return allocate_block(new_bytes);
+  }
+#ifdef KL_MAPPED_BLOCKS
+  if (is_mapped(bytes)) {
+    return grow_mapped(block, bytes, new_bytes);
+  }
+  if (is_mapped(new_bytes)) {
+    auto mapped = map_aligned(mapped_size(new_bytes));
+    std::memcpy(mapped, block, bytes);
+    std::free(block);
+    return mapped;
+  }
+#endif
+  auto grown = std::realloc(block, new_bytes);
+  if (grown == nullptr) {
+    throw std::bad_alloc();
+  }
+  return grown;
+}
+
+void release_block(void* block, size_t bytes) {
+  if (block == nullptr) {
+    return;
+  }
+#ifdef KL_MAPPED_BLOCKS
+  if (is_mapped(bytes)) {
+    munmap(block, mapped_size(bytes));
+    return;
+  }
+#endif
+  std::free(block);
+}
+
+} // namespace kl
@@ -0,0 +1,215 @@
+#include "kl/memory/object_pool.hpp"
+#include "kl/ds/array.hpp"
+#include "kl/except.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+
+namespace kl {
+
+// A thread's free list of one pool. The pool is identified by its id, never reused, since a destroyed pool's address
+// can be taken by a new one.
+struct ObjectPool::Cache {
+  uint64_t pool_id;
+  ObjectPool* pool;
+  FreeBlock* head;
+  TSize count;
+};
+
+namespace {
+// The live pools. Their thread lists are returned to them, and the lists of dead ones dropped, under its lock.
+struct Registry {
+  std::mutex lock;
+  Array<ObjectPool*> pools;
+};
+
+// Never destroyed: threads, like those of a static TaskPool, can end after the static objects are gone.
+Registry& registry() {
+  static auto instance = new Registry();
+  return *instance;
+}
+
+std::atomic<uint64_t> next_pool_id = 1;
+} // namespace
+
+// The lists of a thread, returned to their pools when the thread ends.
+struct ObjectPool::ThreadCaches {
+  Array<Cache> caches;
+
+  ThreadCaches() = default;
+  ThreadCaches(const ThreadCaches&) = delete;
+  ThreadCaches& operator=(const ThreadCaches&) = delete;
+
+  ~ThreadCaches() {
+    auto& live = registry();
+    std::lock_guard lock(live.lock);
+    for (auto& cache: caches) {
+      if (cache.head != nullptr && is_alive(live, cache)) {
+        auto last = cache.head;
+        while (last->next != nullptr) {
+          last = last->next;
+        }
+        cache.pool->give_back(cache.head, last);
+      }
+    }
+  }
+
+  // Whether the pool of the list still exists; the registry lock must be held.
+  static bool is_alive(Registry& live, const Cache& cache) {
+    return std::find(live.pools.begin(), live.pools.end(), cache.pool) != live.pools.end() &&
+           cache.pool->m_id == cache.pool_id;
+  }
+
+  // Adds a list for the pool, first dropping the lists of destroyed pools.
+  Cache& add(ObjectPool* pool) {
+    {
+      auto& live = registry();
+      std::lock_guard lock(live.lock);
+      for (TSize i = caches.size() - 1; i >= 0; i--) {
+        if (!is_alive(live, caches[i])) {
+          caches.remove_at(i);
+        }
+      }
+    }
+    caches.push_back({pool->m_id, pool, nullptr, 0});
+    return caches[-1];
+  }
+};
+
+ObjectPool::ObjectPool(size_t block_size)
+    : m_id(next_pool_id.fetch_add(1, std::memory_order_relaxed)),
+      m_block_size((std::max(block_size, size_t{1}) + BlockAlignment - 1) / BlockAlignment * BlockAlignment) {
+  if (block_size > MaxBlockSize) {
+    throw Exception("Invalid pool block size: {}", block_size);
+  }
+  // about 16KB per batch, between 4 and 64 blocks
+  m_batch = static_cast<TSize>(std::clamp(size_t{16 * 1024} / m_block_size, size_t{4}, size_t{64}));
+  auto& live = registry();
+  std::lock_guard lock(live.lock);
+  live.pools.push_back(this);
+}
+
+ObjectPool::~ObjectPool() {
+  {
+    auto& live = registry();
+    std::lock_guard lock(live.lock);
+    auto position = std::find(live.pools.begin(), live.pools.end(), this);
+    live.pools.remove_at(static_cast<TSize>(position - live.pools.begin()));
+  }
+  while (m_slabs != nullptr) {
+    ::operator delete(std::exchange(m_slabs, m_slabs->next), std::align_val_t{SlabSize});
+  }
+}
+
+ObjectPool::Cache& ObjectPool::thread_cache() {
+  thread_local ThreadCaches thread_caches;
+  for (auto& cache: thread_caches.caches) {
+    if (cache.pool_id == m_id) {
+      return cache;
+    }
+  }
+  return thread_caches.add(this);
+}
+
+void* ObjectPool::allocate(size_t bytes) {
+  if (bytes > m_block_size) [[unlikely]] {
+    throw Exception("Block of {} bytes requested from a pool of {} byte blocks", bytes, m_block_size);
+  }
+  auto& cache = thread_cache();
+  if (cache.head == nullptr) [[unlikely]] {
+    refill(cache);
+  }
+  auto block = cache.head;
+  cache.head = block->next;
+  cache.count--;
+  return block;
+}
+
+void ObjectPool::release(void* block) noexcept {
+  if (block == nullptr) {
+    return;
+  }
+  auto slab = reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(block) & ~(SlabSize - 1));
+  auto pool = slab->pool;
+  auto freed = static_cast<FreeBlock*>(block);
+  Cache* thread_list;
+  try {
+    thread_list = &pool->thread_cache();
+  } catch (...) {
+    // no memory for this thread's first list of the pool: the block goes straight to the central list
+    freed->next = nullptr;
+    pool->give_back(freed, freed);
+    return;
+  }
+  auto& cache = *thread_list;
+  freed->next = cache.head;
+  cache.head = freed;
+  if (++cache.count > 2 * pool->m_batch) [[unlikely]] {
+    auto last = cache.head;
+    for (TSize i = 1; i < pool->m_batch; i++) {
+      last = last->next;
+    }
+    auto first = std::exchange(cache.head, last->next);
+    cache.count -= pool->m_batch;
+    pool->give_back(first, last);
+  }
+}
+
+// Moves a batch of blocks to the list, from the central list or else from a slab.
+void ObjectPool::refill(Cache& cache) {
+  std::lock_guard lock(m_lock);
+  if (m_free != nullptr) {
+    auto last = m_free;
+    TSize count = 1;
+    for (; count < m_batch && last->next != nullptr; count++) {
+      last = last->next;
+    }
+    cache.head = std::exchange(m_free, last->next);
+    last->next = nullptr;
+    cache.count = count;
+    return;
+  }
+  if (static_cast<size_t>(m_slab_end - m_carved) < m_block_size) {
+    auto slab = new (::operator new(SlabSize, std::align_val_t{SlabSize})) Slab{this, m_slabs};
+    m_slabs = slab;
+    m_carved = reinterpret_cast<TByte*>(slab) + BlockAlignment;
+    m_slab_end = reinterpret_cast<TByte*>(slab) + SlabSize;
+  }
+  auto count = static_cast<TSize>(std::min(static_cast<size_t>(m_slab_end - m_carved) / m_block_size,
+                                           static_cast<size_t>(m_batch)));
+  auto first = reinterpret_cast<FreeBlock*>(m_carved);
+  for (TSize i = 0; i < count; i++, m_carved += m_block_size) {
+    reinterpret_cast<FreeBlock*>(m_carved)->next =
+        i + 1 < count ? reinterpret_cast<FreeBlock*>(m_carved + m_block_size) : nullptr;
+  }
+  cache.head = first;
+  cache.count = count;
+}
+
+void ObjectPool::give_back(FreeBlock* first, FreeBlock* last) {
+  std::lock_guard lock(m_lock);
+  last->next = m_free;
+  m_free = first;
+}
+
+SizedObjectPools::SizedObjectPools() {
+  for (TSize i = 0; i < ClassCount; i++) {
+    m_pools[i] = make_ptr<ObjectPool>(size_t{16} << i);
+  }
+}
+
+ObjectPool& SizedObjectPools::pool_for(size_t bytes) {
+  if (bytes > ObjectPool::MaxBlockSize) [[unlikely]] {
+    throw Exception("No pool for blocks of {} bytes", bytes);
+  }
+  auto index = bytes <= 16 ? 0 : std::bit_width(bytes - 1) - 4;
+  return *m_pools[static_cast<TSize>(index)];
+}
+
+// Never destroyed, like the registry: objects from the shared pools can be released after the static objects are gone.
+SizedObjectPools& SizedObjectPools::shared() {
+  static auto pools = new SizedObjectPools();
+  return *pools;
+}
+
+} // namespace kl
@@ -0,0 +1,146 @@
+#include "kl/parallel/task_pool.hpp"
+#include "kl/except.hpp"
+#include <new>
+
+namespace kl {
+
+namespace {
+// The pool whose worker runs on this thread, and the queue of that worker.
+thread_local const TaskPool* worker_pool = nullptr;
+thread_local TSize worker_queue = 0;
+} // namespace
+
+TaskPool::TaskPool(TSize threads) {
+  if (threads < 1 || threads > 4096) {
+    throw Exception("Invalid thread count: {}", threads);
+  }
+  m_queue_count = threads;
+  m_queues = static_cast<Queue*>(::operator new(threads * sizeof(Queue), std::align_val_t{alignof(Queue)}));
+  for (TSize i = 0; i < threads; i++) {
+    new (m_queues + i) Queue();
+  }
+  m_workers.reserve(threads - 1);
+  for (TSize i = 0; i < threads - 1; i++) {
+    m_workers.emplace_back([this, i] { work(i); });
+  }
+}
+
+TaskPool::~TaskPool() {
+  {
+    std::lock_guard lock(m_sleep_lock);
+    m_stopping = true;
+  }
+  m_wake.notify_all();
+  for (auto& worker: m_workers) {
+    worker.join();
+  }
+  for (TSize i = 0; i < m_queue_count; i++) {
+    m_queues[i].~Queue();
+  }
+  ::operator delete(m_queues, std::align_val_t{alignof(Queue)});
+}
+
+TSize TaskPool::default_concurrency() { return static_cast<TSize>(std::max(std::thread::hardware_concurrency(), 1u)); }
+
+TaskPool& TaskPool::shared() {
+  static TaskPool pool;
+  return pool;
+}
+
+TSize TaskPool::queue_index() const { return worker_pool == this ? worker_queue : m_queue_count - 1; }
+
+void TaskPool::push(TSize queue, Task task) {
+  {
+    std::lock_guard lock(m_queues[queue].lock);
+    m_queues[queue].tasks.push_back(task);
+  }
+  m_pending.fetch_add(1);
+  // a worker going to sleep counts itself before checking m_pending, so one of the two sees the other
+  if (m_sleeping.load() > 0) {
+    std::lock_guard lock(m_sleep_lock);
+    m_wake.notify_one();
+  }
+}
+
+// Takes the newest task of the given queue, or steals the oldest one of another queue.
+bool TaskPool::pop(TSize queue, Task& task) {
+  if (m_pending.load(std::memory_order_relaxed) == 0) {
+    return false;
+  }
+  for (TSize i = 0; i < m_queue_count; i++) {
+    auto& candidate = m_queues[(queue + i) % m_queue_count];
+    std::lock_guard lock(candidate.lock);
+    if (candidate.tasks.empty()) {
+      continue;
+    }
+    if (i == 0) {
+      task = candidate.tasks.back();
+      candidate.tasks.pop_back();
+    } else {
+      task = candidate.tasks.front();
+      candidate.tasks.pop_front();
+    }
+    m_pending.fetch_sub(1);
+    return true;
+  }
+  return false;
+}
+
+void TaskPool::execute(TSize queue, Task task) {
+  auto job = task.job;
+  while (task.end - task.begin > 1) {
+    auto middle = task.begin + (task.end - task.begin) / 2;
+    push(queue, {job, middle, task.end});
+    task.end = middle;
+  }
+  if (!job->failed.load(std::memory_order_relaxed)) {
+    auto begin = task.begin * job->grain;
+    auto end = job->size - begin > job->grain ? begin + job->grain : job->size;
+    try {
+      job->run(job->fn, Cursor(begin), Cursor(end));
+    } catch (...) {
+      if (!job->failed.exchange(true)) {
+        job->error = std::current_exception();
+      }
+    }
+  }
+  // the last access to the job, which the waiting thread may destroy right after
+  job->remaining.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void TaskPool::work(TSize queue) {
+  worker_pool = this;
+  worker_queue = queue;
+  Task task;
+  while (true) {
+    if (pop(queue, task)) {
+      execute(queue, task);
+      continue;
+    }
+    std::unique_lock lock(m_sleep_lock);
+    m_sleeping.fetch_add(1);
+    m_wake.wait(lock, [this] { return m_pending.load() > 0 || m_stopping.load(); });
+    m_sleeping.fetch_sub(1);
+    if (m_stopping) {
+      return;
+    }
+  }
+}
+
+void TaskPool::run(Job& job) {
+  auto queue = queue_index();
+  execute(queue, {&job, 0, job.remaining.load()});
+  Task task;
+  while (job.remaining.load(std::memory_order_acquire) > 0) {
+    if (pop(queue, task)) {
+      execute(queue, task);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  if (job.error) {
+    std::rethrow_exception(job.error);
+  }
+}
+
+} // namespace kl
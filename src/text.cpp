@@ -1,67 +1,218 @@
 #include "kl/text.hpp"
+#include "kl/text/arena.hpp"
 #include "kl/except.hpp"
+#include "text_utf8.hpp"
+#include <algorithm>
 #include <cstring>
 
 namespace kl {
 
-Text::Text(const Text& value) {
-  m_text_buffer = value.m_text_buffer;
-  base()->add_ref();
-  m_start = value.m_start;
-  m_end = value.m_end;
+namespace {
+struct ResourceHeader {
+  DynamicResource* resource;
+  size_t bytes;
+};
+static_assert(sizeof(ResourceHeader) % alignof(TextRefCountedBase) == 0);
+} // namespace
+
+TextRefCountedBase* TextRefCountedBase::allocate_from(DynamicResource& resource, TSize payload_size) {
+  auto bytes = sizeof(ResourceHeader) + sizeof(TextRefCountedBase) + payload_size;
+  auto header = static_cast<ResourceHeader*>(resource.allocate(bytes));
+  header->resource = &resource;
+  header->bytes = bytes;
+  return reinterpret_cast<TextRefCountedBase*>(header + 1);
 }
 
-Text::Text(Text&& dying) noexcept {
-  m_text_buffer = dying.m_text_buffer;
-  m_start = dying.m_start;
-  m_end = dying.m_end;
-  dying.m_text_buffer = nullptr;
-  dying.m_start = 0;
-  dying.m_end = 0;
+void TextRefCountedBase::release_to_resource(TextRefCountedBase* ptr) {
+  auto header = reinterpret_cast<ResourceHeader*>(ptr) - 1;
+  header->resource->release(header, header->bytes);
 }
 
-Text& Text::operator=(const Text& value) {
-  m_text_buffer = value.m_text_buffer;
-  base()->add_ref();
-  m_start = value.m_start;
-  m_end = value.m_end;
-  return *this;
+void Text::acquire() {
+  if (!is_inline()) {
+    if (base()->is_arena()) [[unlikely]] {
+      promote_arena_buffer();
+    } else {
+      base()->add_ref();
+    }
+  }
 }
 
-Text& Text::operator=(Text&& dying) noexcept {
-  m_text_buffer = dying.m_text_buffer;
-  m_start = dying.m_start;
-  m_end = dying.m_end;
-  dying.m_text_buffer = nullptr;
-  dying.m_start = 0;
-  dying.m_end = 0;
-  return *this;
+// The copy can outlive any TextResourceScope active now, like the arena text itself can.
+void Text::promote_arena_buffer() {
+  Text copy(begin(), size(), TextSharing::Local, TextAllocation::Heap);
+  m_repr = copy.m_repr;
+  copy.m_repr.buffer = empty_buffer();
 }
 
 Text::Text(char c) : Text(&c, 1) {}
 
-Text::Text(const char* ptr) {
-  TSize size = 0;
+Text::Text(const char* ptr) : Text(ptr, ptr != nullptr ? static_cast<TSize>(std::strlen(ptr)) : 0) {}
+
+Text::Text(const char* ptr, TSize size) : Text(ptr, size, TextSharing::Local) {}
 
-  if (ptr != nullptr) {
-    size = std::strlen(ptr);
+Text::Text(const char* ptr, TSize size, TextSharing sharing) : Text(ptr, size, sharing, TextAllocation::Scoped) {}
+
+Text::Text(const char* ptr, TSize size, TextSharing sharing, TextAllocation allocation) {
+  if (ptr == nullptr || size <= 0) {
+    return;
   }
-  *this = Text(ptr, size);
+  if (size <= InlineCapacity) {
+    m_repr.small = {};
+    std::memcpy(m_repr.small.data, ptr, size);
+    m_repr.small.tag = InlineTag | static_cast<TByte>(size);
+    return;
+  }
+  auto counted_base = TextRefCountedBase::allocate(size, sharing, allocation);
+  std::memcpy(counted_base->text_address(), ptr, size);
+  m_repr.buffer = {counted_base->text_address(), 0, size};
 }
 
-Text::Text(const char* ptr, TSize size) {
-  if (ptr == nullptr || size <= 0) {
-    *this = Text{""_tr};
+Text::Text(const char* ptr, TSize size, TextArena& arena) {
+  if (ptr == nullptr || size <= InlineCapacity) {
+    *this = Text(ptr, size);
     return;
   }
-  auto counted_base = TextRefCountedBase::allocate(size);
-  m_text_buffer = counted_base->text_address();
-  m_start = 0;
-  m_end = size;
+  auto counted_base = arena.allocate(size);
+  std::memcpy(counted_base->text_address(), ptr, size);
+  m_repr.buffer = {counted_base->text_address(), 0, size};
+}
+
+bool Text::is_shared() const {
+  return is_inline() || base()->is_shared() || (base()->refcount == RefCountedGuard && !base()->is_arena());
+}
+
+Text Text::shared() const {
+  if (is_shared()) {
+    return *this;
+  }
+  auto ptr = base();
+  if (ptr->refcount == 1) {
+    ptr->flags |= TextRefCountedBase::SharedFlag;
+    return *this;
+  }
+  return Text(begin(), size(), TextSharing::Shared, TextAllocation::Heap);
+}
+
+bool Text::covers_buffer() const {
+  return !is_inline() && m_repr.buffer.start == 0 && m_repr.buffer.end == base()->size;
+}
+
+uint64_t Text::cached_hash() const {
+  if (!covers_buffer()) {
+    return hash_bytes(begin(), size());
+  }
+  auto ptr = base();
+  // Shared buffers may be hashed from several threads at once; they all store the same value.
+  std::atomic_ref cached(ptr->hash);
+  auto value = cached.load(std::memory_order_relaxed);
+  if (value == 0) {
+    value = hash_bytes(begin(), size());
+    if (ptr->refcount != RefCountedGuard || ptr->is_arena()) { // literals are read-only and already have theirs
+      cached.store(value, std::memory_order_relaxed);
+    }
+  }
+  return value;
+}
+
+TSize Text::buffer_utf8_state() const {
+  auto ptr = base();
+  std::atomic_ref cached(ptr->utf8);
+  auto state = cached.load(std::memory_order_relaxed);
+  if (state == 0) {
+    const auto& kernels = text_utf8::kernels();
+    if (!kernels.validate(begin(), end())) {
+      state = -1;
+    } else if (auto code_points = kernels.count_code_points(begin(), end()); code_points < TSIZE_MAX) {
+      state = code_points + 1;
+    } else {
+      return 0; // does not fit, is not cached
+    }
+    if (ptr->refcount != RefCountedGuard || ptr->is_arena()) {
+      cached.store(state, std::memory_order_relaxed);
+    }
+  }
+  return state;
+}
+
+bool Text::in_ascii_buffer() const {
+  if (is_inline()) {
+    return false;
+  }
+  auto ptr = base();
+  return std::atomic_ref(ptr->utf8).load(std::memory_order_relaxed) == ptr->size + 1;
+}
+
+bool Text::is_valid_utf8() const {
+  if (covers_buffer()) {
+    if (auto state = buffer_utf8_state(); state != 0) {
+      return state > 0;
+    }
+  } else if (in_ascii_buffer()) {
+    return true;
+  }
+  return text_utf8::kernels().validate(begin(), end());
+}
+
+TSize Text::utf8_length() const {
+  if (covers_buffer()) {
+    if (auto state = buffer_utf8_state(); state > 0) {
+      return state - 1;
+    }
+  } else if (in_ascii_buffer()) {
+    return size();
+  }
+  return text_utf8::kernels().count_code_points(begin(), end());
+}
+
+Text Text::utf8_sublen(TSize start, TSize len) const {
+  if (start < 0 || len <= 0) {
+    return {};
+  }
+  if (in_ascii_buffer()) {
+    return sublen(start, len);
+  }
+  const auto& kernels = text_utf8::kernels();
+  auto first = kernels.advance(begin(), end(), start);
+  if (first == end()) {
+    return {};
+  }
+  auto last = kernels.advance(first, end(), len);
+  return slice(static_cast<TSize>(first - begin()), static_cast<TSize>(last - first));
+}
 
-  for (TSize i = 0; i < size; i++) {
-    m_text_buffer[i] = ptr[i];
+Text Text::shared_slice(TSize start, TSize length) const {
+  if (is_inline()) {
+    return {begin() + start, length};
+  }
+  auto ptr = base();
+  if (!ptr->is_arena()) {
+    ptr->add_ref();
+  }
+  Text result;
+  auto text_start = m_repr.buffer.start + start;
+  result.m_repr.buffer = {m_repr.buffer.text_buffer, text_start, text_start + length};
+  return result;
+}
+
+Array<Text> Text::split_by_char(char c, SplitEmpty on_empty) const {
+  Array<Text> res;
+  auto p = begin();
+  auto e = end();
+  while (p < e) {
+    auto found = find_char(p, e, c);
+    if (found > p || on_empty == SplitEmpty::Keep) {
+      res.push_back(slice(static_cast<TSize>(p - begin()), static_cast<TSize>(found - p)));
+    }
+    if (found == e) {
+      break;
+    }
+    p = found + 1;
+  }
+  if (on_empty == SplitEmpty::Keep && (size() == 0 || ends_with(c))) {
+    res.push_back(Text{});
   }
+  return res;
 }
 
 } // namespace kl
@@ -0,0 +1,81 @@
+#include "kl/text/arena.hpp"
+#include "kl/except.hpp"
+#include <algorithm>
+
+namespace kl {
+
+TextArena::TextArena(TSize block_size) : m_block_size(std::max(block_size, TSize{1024})) {}
+
+TextArena::~TextArena() {
+  while (m_blocks != nullptr) {
+    auto next = m_blocks->next;
+    delete[] reinterpret_cast<char*>(m_blocks);
+    m_blocks = next;
+  }
+}
+
+TextArena::Block* TextArena::add_block(TSize capacity) {
+  auto block = reinterpret_cast<Block*>(new char[sizeof(Block) + capacity]);
+  block->capacity = capacity;
+  block->used = 0;
+  if (m_blocks != nullptr && capacity > m_block_size) {
+    // oversized blocks go behind the current one, which may still have room for small buffers
+    block->next = m_blocks->next;
+    m_blocks->next = block;
+  } else {
+    block->next = m_blocks;
+    m_blocks = block;
+  }
+  return block;
+}
+
+TextRefCountedBase* TextArena::allocate(TSize payload_size) {
+  payload_size = std::max(payload_size, 0);
+  constexpr TSize Alignment = alignof(TextRefCountedBase);
+  constexpr TSize HeaderSize = sizeof(TextRefCountedBase);
+  if (payload_size > TSIZE_MAX - HeaderSize - Alignment) [[unlikely]] {
+    throw Exception("Arena allocation too large: {}", payload_size);
+  }
+  TSize required = (HeaderSize + payload_size + Alignment - 1) & ~(Alignment - 1);
+
+  auto block = m_blocks;
+  if (block == nullptr || block->capacity - block->used < required) {
+    block = add_block(std::max(required, m_block_size));
+  }
+  auto base = reinterpret_cast<TextRefCountedBase*>(block->data() + block->used);
+  block->used += required;
+  base->size = payload_size;
+  base->refcount = RefCountedGuard;
+  base->flags = TextRefCountedBase::ArenaFlag;
+  base->utf8 = 0;
+  base->hash = 0;
+  return base;
+}
+
+void TextArena::reset() {
+  Block* kept = nullptr;
+  while (m_blocks != nullptr) {
+    auto next = m_blocks->next;
+    if (kept == nullptr && m_blocks->capacity == m_block_size) {
+      kept = m_blocks;
+    } else {
+      delete[] reinterpret_cast<char*>(m_blocks);
+    }
+    m_blocks = next;
+  }
+  if (kept != nullptr) {
+    kept->next = nullptr;
+    kept->used = 0;
+  }
+  m_blocks = kept;
+}
+
+TSize TextArena::used_bytes() const {
+  TSize used = 0;
+  for (auto block = m_blocks; block != nullptr; block = block->next) {
+    used += block->used;
+  }
+  return used;
+}
+
+} // namespace kl
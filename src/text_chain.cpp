@@ -0,0 +1,251 @@
+#include "kl/text/chain.hpp"
+#include "kl/except.hpp"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace kl {
+
+TextChain::TextChain(std::initializer_list<Text> list) {
+  for (const auto& text: list) {
+    add(text);
+  }
+}
+
+TextChain::TextChain(const Array<Text>& list) {
+  for (const auto& text: list) {
+    add(text);
+  }
+}
+
+TextChain::TextChain(const TextChain& value)
+    : m_segments(value.m_segments), m_offsets(value.m_offsets), m_size(value.m_size) {}
+
+TextChain::TextChain(TextChain&& dying) noexcept
+    : m_segments(std::move(dying.m_segments)), m_offsets(std::move(dying.m_offsets)),
+      m_size(std::exchange(dying.m_size, 0)), m_storage(std::move(dying.m_storage)),
+      m_storage_base(std::exchange(dying.m_storage_base, nullptr)),
+      m_flat_segments(std::exchange(dying.m_flat_segments, 0)) {}
+
+TextChain& TextChain::operator=(const TextChain& value) {
+  if (this != &value) {
+    *this = TextChain(value);
+  }
+  return *this;
+}
+
+TextChain& TextChain::operator=(TextChain&& dying) noexcept {
+  if (this != &dying) {
+    m_segments = std::move(dying.m_segments);
+    m_offsets = std::move(dying.m_offsets);
+    m_size = std::exchange(dying.m_size, 0);
+    m_storage = std::move(dying.m_storage);
+    m_storage_base = std::exchange(dying.m_storage_base, nullptr);
+    m_flat_segments = std::exchange(dying.m_flat_segments, 0);
+  }
+  return *this;
+}
+
+void TextChain::add(const Text& text) {
+  if (text.size() > TSIZE_MAX - m_size) [[unlikely]] {
+    throw Exception("TextChain too large: {} + {}", m_size, text.size());
+  }
+  m_offsets.push_back(m_size);
+  m_segments.push_back(text);
+  m_size += text.size();
+}
+
+void TextChain::add(const TextChain& chain) {
+  auto count = chain.m_segments.size(); // the chain may be this one
+  for (TSize i = 0; i < count; i++) {
+    Text segment = chain.m_segments[i];
+    add(segment);
+  }
+}
+
+void TextChain::operator+=(const Text& text) { add(text); }
+void TextChain::operator+=(const TextChain& chain) { add(chain); }
+
+void TextChain::clear() { *this = TextChain(); }
+
+TSize TextChain::size() const { return m_size; }
+const Array<Text>& TextChain::segments() const { return m_segments; }
+
+TSize TextChain::segment_index(TSize position) const {
+  auto it = std::upper_bound(m_offsets.begin(), m_offsets.end(), position);
+  return static_cast<TSize>(it - m_offsets.begin()) - 1;
+}
+
+void TextChain::flatten() const {
+  auto count = m_segments.size();
+  if (m_flat_segments == count) {
+    return;
+  }
+  if (m_storage_base == nullptr || m_storage_base->size < m_size) {
+    int64_t previous_capacity = m_storage_base != nullptr ? m_storage_base->size : 0;
+    auto capacity = static_cast<TSize>(std::min<int64_t>(std::max<int64_t>(m_size, previous_capacity * 2), TSIZE_MAX));
+    auto base = TextRefCountedBase::allocate(capacity);
+    if (m_flat_segments > 0) {
+      std::memcpy(base->text_address(), m_storage_base->text_address(), m_offsets[m_flat_segments]);
+    }
+    m_storage = Text(base); // adopts the reference of the new buffer
+    m_storage_base = base;
+  }
+  for (TSize i = m_flat_segments; i < count; i++) {
+    const auto& segment = m_segments[i];
+    std::memcpy(m_storage_base->text_address() + m_offsets[i], segment.begin(), segment.size());
+  }
+  m_flat_segments = count;
+}
+
+Text TextChain::to_text() const {
+  if (m_segments.size() == 1) {
+    return m_segments[0];
+  }
+  if (m_size == 0) {
+    return {};
+  }
+  flatten();
+  return m_storage.sublen(0, m_size);
+}
+
+TextChain::operator Text() const { return to_text(); }
+
+Text TextChain::join(char split_char) const {
+  if (split_char == '\0') {
+    return to_text();
+  }
+  return join(Text(split_char));
+}
+
+Text TextChain::join(const Text& split_text, const Text& prefix, const Text& suffix) const {
+  if (split_text.size() == 0 && prefix.size() == 0 && suffix.size() == 0) {
+    return to_text();
+  }
+  auto count = m_segments.size();
+  int64_t total = int64_t{m_size} + prefix.size() + suffix.size() + int64_t{split_text.size()} * std::max(count - 1, 0);
+  if (total > TSIZE_MAX) [[unlikely]] {
+    throw Exception("Joined text too large: {}", total);
+  }
+  auto base = TextRefCountedBase::allocate(static_cast<TSize>(total));
+  auto ptr = base->text_address();
+  auto append = [&ptr](const Text& text) {
+    std::memcpy(ptr, text.begin(), text.size());
+    ptr += text.size();
+  };
+  append(prefix);
+  for (TSize i = 0; i < count; i++) {
+    if (i > 0) {
+      append(split_text);
+    }
+    append(m_segments[i]);
+  }
+  append(suffix);
+  return Text(base);
+}
+
+char TextChain::operator[](TSize index) const {
+  if (index < 0) {
+    index += m_size;
+  }
+  if (index >= m_size || index < 0) [[unlikely]] {
+    throw Exception("Out of range: {} out of {}", index, m_size);
+  }
+  auto segment = segment_index(index);
+  return m_segments[segment].begin()[index - m_offsets[segment]];
+}
+
+Text TextChain::sublen(TSize start, TSize len) const {
+  if (start < 0 || start >= m_size || len <= 0) {
+    return {};
+  }
+  len = std::min(len, m_size - start);
+  auto segment = segment_index(start);
+  auto local_start = start - m_offsets[segment];
+  if (local_start + len <= m_segments[segment].size()) {
+    return m_segments[segment].sublen(local_start, len);
+  }
+  auto flat_size = m_flat_segments < m_segments.size() ? m_offsets[m_flat_segments] : m_size;
+  if (start + len <= flat_size) {
+    return m_storage.sublen(start, len);
+  }
+  auto base = TextRefCountedBase::allocate(len);
+  auto ptr = base->text_address();
+  for (auto remaining = len; remaining > 0; segment++) {
+    auto piece = std::min(m_segments[segment].size() - local_start, remaining);
+    std::memcpy(ptr, m_segments[segment].begin() + local_start, piece);
+    ptr += piece;
+    remaining -= piece;
+    local_start = 0;
+  }
+  return Text(base);
+}
+
+std::optional<TSize> TextChain::pos(char c, TSize occurence) const {
+  if (occurence <= 0) {
+    return std::nullopt;
+  }
+  for (TSize i = 0; i < m_segments.size(); i++) {
+    const auto& segment = m_segments[i];
+    auto found = segment.count(c);
+    if (found >= occurence) {
+      return m_offsets[i] + *segment.pos(c, occurence);
+    }
+    occurence -= found;
+  }
+  return std::nullopt;
+}
+
+bool TextChain::matches_at(TSize position, const Text& value) const {
+  auto segment = segment_index(position);
+  auto local_start = position - m_offsets[segment];
+  auto needle = value.begin();
+  for (auto remaining = value.size(); remaining > 0; segment++) {
+    auto piece = std::min(m_segments[segment].size() - local_start, remaining);
+    if (std::memcmp(m_segments[segment].begin() + local_start, needle, piece) != 0) {
+      return false;
+    }
+    needle += piece;
+    remaining -= piece;
+    local_start = 0;
+  }
+  return true;
+}
+
+std::optional<TSize> TextChain::pos(const Text& value, TSize occurence) const {
+  auto needle_size = value.size();
+  if (occurence <= 0 || needle_size == 0) {
+    return std::nullopt;
+  }
+  TSize position = 0;
+  while (m_size - position >= needle_size) {
+    auto segment = segment_index(position);
+    auto segment_start = m_offsets[segment];
+    auto segment_end = segment_start + m_segments[segment].size();
+    TSize match = -1;
+    if (auto found = m_segments[segment].skip(position - segment_start).pos(value); found.has_value()) {
+      match = position + *found;
+    } else {
+      // matches that start in this segment and continue in the next ones
+      auto candidate = std::max(position, segment_end - needle_size + 1);
+      for (; candidate < segment_end && m_size - candidate >= needle_size; candidate++) {
+        if (matches_at(candidate, value)) {
+          match = candidate;
+          break;
+        }
+      }
+      if (match < 0) {
+        position = segment_end;
+        continue;
+      }
+    }
+    occurence--;
+    if (occurence == 0) {
+      return match;
+    }
+    position = match + needle_size;
+  }
+  return std::nullopt;
+}
+
+} // namespace kl
@@ -0,0 +1,95 @@
+#include "kl/text/intern.hpp"
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+namespace kl {
+
+// Small texts have no buffer to share: they are returned as they are.
+bool TextInternTable::is_small(std::string_view value) { return value.size() <= Text::InlineCapacity; }
+
+// Interned texts always start at their buffer's beginning; only the table references one whose count is down to one.
+bool TextInternTable::table_only_reference(const Text& value) {
+  return std::atomic_ref(value.base()->refcount).load(std::memory_order_acquire) == 1;
+}
+
+bool TextInternTable::is_full_literal(const Text& value) {
+  auto base = value.base();
+  return base->refcount == RefCountedGuard && !base->is_arena() && value.m_repr.buffer.start == 0 &&
+         value.m_repr.buffer.end == base->size;
+}
+
+size_t TextInternTable::Hash::operator()(std::string_view value) const {
+  return hash_bytes(value.data(), value.size());
+}
+size_t TextInternTable::Hash::operator()(const Text& value) const { return value.hash(); }
+
+TextInternTable::TextInternTable(InternMode mode, TSize shard_count)
+    : m_mode(mode),
+      m_shard_mask(static_cast<TSize>(std::bit_ceil(static_cast<uint32_t>(std::max(shard_count, 1)))) - 1),
+      m_shards(std::make_unique<Shard[]>(m_shard_mask + 1)) {}
+
+Text TextInternTable::intern(std::string_view value, const Text* source) {
+  auto& shard = m_shards[Hash{}(value) & m_shard_mask];
+  std::lock_guard guard(shard.lock);
+  auto it = shard.texts.find(value);
+  if (it != shard.texts.end()) {
+    return *it;
+  }
+  if (m_mode == InternMode::Weak && shard.texts.size() >= shard.sweep_threshold) {
+    sweep(shard);
+  }
+  // Literals are kept as they are. Anything else gets its own exact-size buffer, so that the canonical text does not
+  // pin a larger buffer it was sliced from, and so that it can be shared by all the threads. It comes from the heap,
+  // as it lives as long as the table, past any TextResourceScope.
+  if (source != nullptr && is_full_literal(*source)) {
+    return *shard.texts.insert(*source).first;
+  }
+  Text canonical(value.data(), static_cast<TSize>(value.size()), TextSharing::Shared, TextAllocation::Heap);
+  return *shard.texts.insert(std::move(canonical)).first;
+}
+
+Text TextInternTable::intern(const Text& value) {
+  if (is_small(value.to_view())) {
+    return value;
+  }
+  return intern(value.to_view(), &value);
+}
+
+Text TextInternTable::intern(std::string_view value) {
+  if (is_small(value)) {
+    return Text(value.data(), static_cast<TSize>(value.size()));
+  }
+  return intern(value, nullptr);
+}
+
+void TextInternTable::sweep(Shard& shard) {
+  std::erase_if(shard.texts, table_only_reference);
+  shard.sweep_threshold = std::max<size_t>(shard.texts.size() * 2, 64);
+}
+
+void TextInternTable::sweep() {
+  if (m_mode != InternMode::Weak) {
+    return;
+  }
+  for (TSize i = 0; i <= m_shard_mask; i++) {
+    std::lock_guard guard(m_shards[i].lock);
+    sweep(m_shards[i]);
+  }
+}
+
+TSize TextInternTable::size() {
+  size_t total = 0;
+  for (TSize i = 0; i <= m_shard_mask; i++) {
+    std::lock_guard guard(m_shards[i].lock);
+    total += m_shards[i].texts.size();
+  }
+  return static_cast<TSize>(total);
+}
+
+Text intern(const Text& value) {
+  static TextInternTable table;
+  return table.intern(value);
+}
+
+} // namespace kl
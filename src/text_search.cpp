@@ -0,0 +1,150 @@
+#include "text_search.hpp"
+#include "text_simd.hpp"
+#include "kl/text.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+namespace kl::text_search {
+
+namespace {
+
+bool in_set(char c, const char* set, TSize set_size) {
+  for (TSize i = 0; i < set_size; i++) {
+    if (set[i] == c) {
+      return true;
+    }
+  }
+  return false;
+}
+
+const char* scalar_find_char(const char* begin, const char* end, char c) {
+  for (auto p = begin; p < end; p++) {
+    if (*p == c) {
+      return p;
+    }
+  }
+  return end;
+}
+
+const char* scalar_find_last_char(const char* begin, const char* end, char c) {
+  for (auto p = end; p > begin; p--) {
+    if (*(p - 1) == c) {
+      return p - 1;
+    }
+  }
+  return end;
+}
+
+TSize scalar_count_char(const char* begin, const char* end, char c) {
+  TSize count = 0;
+  for (auto p = begin; p < end; p++) {
+    count += (*p == c) ? 1 : 0;
+  }
+  return count;
+}
+
+const char* scalar_find_first_not_of(const char* begin, const char* end, const char* set, TSize set_size) {
+  for (auto p = begin; p < end; p++) {
+    if (!in_set(*p, set, set_size)) {
+      return p;
+    }
+  }
+  return end;
+}
+
+const char* scalar_find_last_not_of(const char* begin, const char* end, const char* set, TSize set_size) {
+  for (auto p = end; p > begin; p--) {
+    if (!in_set(*(p - 1), set, set_size)) {
+      return p - 1;
+    }
+  }
+  return end;
+}
+
+const char* scalar_find_text(const char* begin, const char* end, const char* needle, TSize needle_size) {
+  for (auto p = begin; end - p >= needle_size; p++) {
+    if (*p == needle[0] && std::memcmp(p + 1, needle + 1, needle_size - 1) == 0) {
+      return p;
+    }
+  }
+  return end;
+}
+
+const Kernels Scalar{.find_char = scalar_find_char,
+                     .find_last_char = scalar_find_last_char,
+                     .count_char = scalar_count_char,
+                     .find_first_not_of = scalar_find_first_not_of,
+                     .find_last_not_of = scalar_find_last_not_of,
+                     .find_text = scalar_find_text,
+                     .name = "scalar"};
+
+// Sets larger than this (rare: the whitespace set has 4 characters) are matched by the scalar kernels.
+constexpr TSize MaxVectorSetSize = 16;
+
+} // namespace
+
+#ifdef KL_TEXT_SIMD_X86
+namespace sse2 {
+#define KL_SIMD_TARGET KL_SSE2_TARGET
+constexpr const char* VariantName = "sse2";
+using Simd = text_simd::Sse2;
+namespace {
+#include "text_search_simd.inl"
+} // namespace
+#undef KL_SIMD_TARGET
+} // namespace sse2
+
+namespace avx2 {
+#define KL_SIMD_TARGET KL_AVX2_TARGET
+constexpr const char* VariantName = "avx2";
+using Simd = text_simd::Avx2;
+namespace {
+#include "text_search_simd.inl"
+} // namespace
+#undef KL_SIMD_TARGET
+} // namespace avx2
+#endif
+
+const Kernels& scalar_kernels() { return Scalar; }
+
+const Kernels& sse2_kernels() {
+#ifdef KL_TEXT_SIMD_X86
+  if (__builtin_cpu_supports("sse2")) {
+    return sse2::Variant;
+  }
+#endif
+  return Scalar;
+}
+
+const Kernels& avx2_kernels() {
+#ifdef KL_TEXT_SIMD_X86
+  if (__builtin_cpu_supports("avx2")) {
+    return avx2::Variant;
+  }
+#endif
+  return sse2_kernels();
+}
+
+const Kernels& kernels() {
+  static const Kernels& selected = avx2_kernels();
+  return selected;
+}
+
+const char* find_char(const char* begin, const char* end, char c) { return kernels().find_char(begin, end, c); }
+const char* find_last_char(const char* begin, const char* end, char c) {
+  return kernels().find_last_char(begin, end, c);
+}
+TSize count_char(const char* begin, const char* end, char c) { return kernels().count_char(begin, end, c); }
+const char* find_first_not_of(const char* begin, const char* end, const char* set, TSize set_size) {
+  return kernels().find_first_not_of(begin, end, set, set_size);
+}
+const char* find_last_not_of(const char* begin, const char* end, const char* set, TSize set_size) {
+  return kernels().find_last_not_of(begin, end, set, set_size);
+}
+const char* find_text(const char* begin, const char* end, const char* needle, TSize needle_size) {
+  return kernels().find_text(begin, end, needle, needle_size);
+}
+
+} // namespace kl::text_search
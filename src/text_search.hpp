@@ -0,0 +1,32 @@
+#pragma once
+#include <kl/inttypes.hpp>
+
+// Search kernels used by kl::Text. The implementation is selected once, at first use, from the scalar, SSE2 and
+// AVX2 variants according to what the CPU supports.
+namespace kl::text_search {
+
+struct Kernels {
+  // First occurrence of c in [begin, end), or end.
+  const char* (*find_char)(const char* begin, const char* end, char c);
+  // Last occurrence of c in [begin, end), or end.
+  const char* (*find_last_char)(const char* begin, const char* end, char c);
+  // Number of occurrences of c in [begin, end).
+  TSize (*count_char)(const char* begin, const char* end, char c);
+  // First character in [begin, end) that is not part of the set, or end.
+  const char* (*find_first_not_of)(const char* begin, const char* end, const char* set, TSize set_size);
+  // Last character in [begin, end) that is not part of the set, or end.
+  const char* (*find_last_not_of)(const char* begin, const char* end, const char* set, TSize set_size);
+  // First occurrence of the needle in [begin, end), or end. The needle is not empty.
+  const char* (*find_text)(const char* begin, const char* end, const char* needle, TSize needle_size);
+  const char* name;
+};
+
+// Each variant falls back to the next simpler one when the CPU does not support it.
+const Kernels& scalar_kernels();
+const Kernels& sse2_kernels();
+const Kernels& avx2_kernels();
+
+// The kernels for the running CPU.
+const Kernels& kernels();
+
+} // namespace kl::text_search
@@ -0,0 +1,126 @@
+// Vector kernels shared by the SSE2 and AVX2 variants. Included from text_search.cpp inside a namespace that defines
+// Simd (the vector operations) and KL_SIMD_TARGET (the target attribute applied to every function).
+
+KL_SIMD_TARGET const char* find_char(const char* begin, const char* end, char c) {
+  const auto needle = Simd::splat(c);
+  auto p = begin;
+  for (; end - p >= Simd::Width; p += Simd::Width) {
+    auto mask = Simd::eq_mask(Simd::load(p), needle);
+    if (mask != 0) {
+      return p + std::countr_zero(mask);
+    }
+  }
+  return scalar_find_char(p, end, c);
+}
+
+KL_SIMD_TARGET const char* find_last_char(const char* begin, const char* end, char c) {
+  const auto needle = Simd::splat(c);
+  auto p = end;
+  for (; p - begin >= Simd::Width; p -= Simd::Width) {
+    auto mask = Simd::eq_mask(Simd::load(p - Simd::Width), needle);
+    if (mask != 0) {
+      return p - Simd::Width + std::bit_width(mask) - 1;
+    }
+  }
+  auto result = scalar_find_last_char(begin, p, c);
+  return result == p ? end : result;
+}
+
+KL_SIMD_TARGET TSize count_char(const char* begin, const char* end, char c) {
+  const auto needle = Simd::splat(c);
+  TSize count = 0;
+  auto p = begin;
+  while (end - p >= Simd::Width) {
+    // every match subtracts -1 from its byte lane, which can take 255 of them before it has to be folded
+    auto blocks = std::min<ptrdiff_t>((end - p) / Simd::Width, 255);
+    auto blocks_end = p + blocks * Simd::Width;
+    auto lanes = Simd::zero();
+    for (; p < blocks_end; p += Simd::Width) {
+      lanes = Simd::sub(lanes, Simd::eq(Simd::load(p), needle));
+    }
+    count += Simd::sum_bytes(lanes);
+  }
+  return count + scalar_count_char(p, end, c);
+}
+
+struct CharSet {
+  Simd::Vector chars[MaxVectorSetSize];
+  TSize size;
+
+  KL_SIMD_TARGET CharSet(const char* set, TSize set_size) : size(set_size) {
+    for (TSize i = 0; i < set_size; i++) {
+      chars[i] = Simd::splat(set[i]);
+    }
+  }
+
+  // Bit i is set when the i-th character of the block is *not* part of the set.
+  KL_SIMD_TARGET uint32_t outside_mask(const char* p) const {
+    auto block = Simd::load(p);
+    uint32_t mask = 0;
+    for (TSize i = 0; i < size; i++) {
+      mask |= Simd::eq_mask(block, chars[i]);
+    }
+    return ~mask & Simd::FullMask;
+  }
+};
+
+KL_SIMD_TARGET const char* find_first_not_of(const char* begin, const char* end, const char* set, TSize set_size) {
+  if (set_size > MaxVectorSetSize) {
+    return scalar_find_first_not_of(begin, end, set, set_size);
+  }
+  const CharSet chars(set, set_size);
+  auto p = begin;
+  for (; end - p >= Simd::Width; p += Simd::Width) {
+    auto mask = chars.outside_mask(p);
+    if (mask != 0) {
+      return p + std::countr_zero(mask);
+    }
+  }
+  return scalar_find_first_not_of(p, end, set, set_size);
+}
+
+KL_SIMD_TARGET const char* find_last_not_of(const char* begin, const char* end, const char* set, TSize set_size) {
+  if (set_size > MaxVectorSetSize) {
+    return scalar_find_last_not_of(begin, end, set, set_size);
+  }
+  const CharSet chars(set, set_size);
+  auto p = end;
+  for (; p - begin >= Simd::Width; p -= Simd::Width) {
+    auto mask = chars.outside_mask(p - Simd::Width);
+    if (mask != 0) {
+      return p - Simd::Width + std::bit_width(mask) - 1;
+    }
+  }
+  auto result = scalar_find_last_not_of(begin, p, set, set_size);
+  return result == p ? end : result;
+}
+
+// Compares the first and the last character of the needle against a block of candidate positions at once, and only
+// checks the rest of the needle where both match.
+KL_SIMD_TARGET const char* find_text(const char* begin, const char* end, const char* needle, TSize needle_size) {
+  if (needle_size == 1) {
+    return find_char(begin, end, needle[0]);
+  }
+  const auto first = Simd::splat(needle[0]);
+  const auto last = Simd::splat(needle[needle_size - 1]);
+  auto p = begin;
+  for (; end - p >= Simd::Width + needle_size - 1; p += Simd::Width) {
+    auto mask = Simd::eq_mask(Simd::load(p), first) & Simd::eq_mask(Simd::load(p + needle_size - 1), last);
+    while (mask != 0) {
+      auto candidate = p + std::countr_zero(mask);
+      if (std::memcmp(candidate + 1, needle + 1, needle_size - 2) == 0) {
+        return candidate;
+      }
+      mask &= mask - 1;
+    }
+  }
+  return scalar_find_text(p, end, needle, needle_size);
+}
+
+const Kernels Variant{.find_char = find_char,
+                      .find_last_char = find_last_char,
+                      .count_char = count_char,
+                      .find_first_not_of = find_first_not_of,
+                      .find_last_not_of = find_last_not_of,
+                      .find_text = find_text,
+                      .name = VariantName};
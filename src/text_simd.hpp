@@ -0,0 +1,58 @@
+#pragma once
+#include <kl/inttypes.hpp>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KL_TEXT_SIMD_X86 1
+#endif
+
+// Vector operations shared by the SIMD text kernels. Kernels are compiled once per instruction set, each with the
+// matching target attribute, so that the library itself does not have to be built for a particular CPU.
+#ifdef KL_TEXT_SIMD_X86
+#define KL_SSE2_TARGET __attribute__((target("sse2")))
+#define KL_AVX2_TARGET __attribute__((target("avx2")))
+
+namespace kl::text_simd {
+
+struct Sse2 {
+  using Vector = __m128i;
+  static constexpr TSize Width = 16;
+  static constexpr uint32_t FullMask = 0xFFFF;
+  KL_SSE2_TARGET static Vector load(const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+  KL_SSE2_TARGET static Vector splat(char c) { return _mm_set1_epi8(c); }
+  KL_SSE2_TARGET static Vector zero() { return _mm_setzero_si128(); }
+  KL_SSE2_TARGET static Vector eq(Vector a, Vector b) { return _mm_cmpeq_epi8(a, b); }
+  // signed comparison
+  KL_SSE2_TARGET static Vector gt(Vector a, Vector b) { return _mm_cmpgt_epi8(a, b); }
+  KL_SSE2_TARGET static Vector sub(Vector a, Vector b) { return _mm_sub_epi8(a, b); }
+  // bit i is the high bit of byte i
+  KL_SSE2_TARGET static uint32_t mask(Vector v) { return static_cast<uint32_t>(_mm_movemask_epi8(v)); }
+  KL_SSE2_TARGET static uint32_t eq_mask(Vector a, Vector b) { return mask(_mm_cmpeq_epi8(a, b)); }
+  KL_SSE2_TARGET static TSize sum_bytes(Vector v) {
+    auto sums = _mm_sad_epu8(v, _mm_setzero_si128());
+    return static_cast<TSize>(_mm_cvtsi128_si32(sums) + _mm_extract_epi16(sums, 4));
+  }
+};
+
+struct Avx2 {
+  using Vector = __m256i;
+  static constexpr TSize Width = 32;
+  static constexpr uint32_t FullMask = 0xFFFFFFFF;
+  KL_AVX2_TARGET static Vector load(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+  KL_AVX2_TARGET static Vector splat(char c) { return _mm256_set1_epi8(c); }
+  KL_AVX2_TARGET static Vector zero() { return _mm256_setzero_si256(); }
+  KL_AVX2_TARGET static Vector eq(Vector a, Vector b) { return _mm256_cmpeq_epi8(a, b); }
+  KL_AVX2_TARGET static Vector gt(Vector a, Vector b) { return _mm256_cmpgt_epi8(a, b); }
+  KL_AVX2_TARGET static Vector sub(Vector a, Vector b) { return _mm256_sub_epi8(a, b); }
+  KL_AVX2_TARGET static uint32_t mask(Vector v) { return static_cast<uint32_t>(_mm256_movemask_epi8(v)); }
+  KL_AVX2_TARGET static uint32_t eq_mask(Vector a, Vector b) { return mask(_mm256_cmpeq_epi8(a, b)); }
+  KL_AVX2_TARGET static TSize sum_bytes(Vector v) {
+    auto sums = _mm256_sad_epu8(v, _mm256_setzero_si256());
+    return static_cast<TSize>(_mm256_extract_epi64(sums, 0) + _mm256_extract_epi64(sums, 1) +
+                              _mm256_extract_epi64(sums, 2) + _mm256_extract_epi64(sums, 3));
+  }
+};
+
+} // namespace kl::text_simd
+#endif
@@ -0,0 +1,229 @@
+#include "text_utf8.hpp"
+#include "text_simd.hpp"
+#include "kl/text/utf8.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+namespace kl::text_utf8 {
+
+namespace {
+
+bool scalar_validate(const char* begin, const char* end) {
+  for (auto p = begin; p < end;) {
+    if (static_cast<TByte>(*p) < 0x80) {
+      p++;
+      continue;
+    }
+    auto length = utf8::sequence_length(p, end);
+    if (length == 0) {
+      return false;
+    }
+    p += length;
+  }
+  return true;
+}
+
+TSize scalar_count_code_points(const char* begin, const char* end) {
+  TSize count = 0;
+  for (auto p = begin; p < end; p++) {
+    count += utf8::is_continuation(*p) ? 0 : 1;
+  }
+  return count;
+}
+
+const char* scalar_advance(const char* begin, const char* end, TSize count) {
+  for (auto p = begin; p < end; p++) {
+    if (!utf8::is_continuation(*p)) {
+      if (count == 0) {
+        return p;
+      }
+      count--;
+    }
+  }
+  return end;
+}
+
+const Kernels Scalar{.validate = scalar_validate,
+                     .count_code_points = scalar_count_code_points,
+                     .advance = scalar_advance,
+                     .name = "scalar"};
+
+} // namespace
+
+#ifdef KL_TEXT_SIMD_X86
+namespace sse2 {
+#define KL_SIMD_TARGET KL_SSE2_TARGET
+using Simd = text_simd::Sse2;
+namespace {
+#include "text_utf8_simd.inl"
+
+// Skips ASCII a block at a time and checks the multi-byte sequences one by one.
+KL_SIMD_TARGET bool validate(const char* begin, const char* end) {
+  auto p = begin;
+  while (end - p >= Simd::Width) {
+    auto mask = Simd::mask(Simd::load(p));
+    if (mask == 0) {
+      p += Simd::Width;
+      continue;
+    }
+    p += std::countr_zero(mask);
+    for (auto block_end = std::min(p + Simd::Width, end); p < block_end;) {
+      auto length = utf8::sequence_length(p, end);
+      if (length == 0) {
+        return false;
+      }
+      p += length;
+    }
+  }
+  return scalar_validate(p, end);
+}
+
+const Kernels Variant{
+    .validate = validate, .count_code_points = count_code_points, .advance = advance, .name = "sse2"};
+} // namespace
+#undef KL_SIMD_TARGET
+} // namespace sse2
+
+namespace avx2 {
+#define KL_SIMD_TARGET KL_AVX2_TARGET
+using Simd = text_simd::Avx2;
+namespace {
+#include "text_utf8_simd.inl"
+
+// Validation by lookup tables (Keiser and Lemire, "Validating UTF-8 in less than one instruction per byte"). Each
+// byte is classified from the high nibble of the previous byte, its low nibble, and the high nibble of the byte
+// itself; the three table lookups have a common bit set exactly when the pair is one of the error patterns below.
+// The remaining errors (missing or extra continuations after 3 and 4 byte leads) are found by comparing the
+// continuation bytes expected from the bytes 2 and 3 positions back with those actually present.
+constexpr TByte TooShort = 1 << 0;     // 11______ 0_______ or 11______ 11______
+constexpr TByte TooLong = 1 << 1;      // 0_______ 10______
+constexpr TByte Overlong3 = 1 << 2;    // 11100000 100_____
+constexpr TByte TooLarge = 1 << 3;     // 11110100 1001____, 11110100 101_____, 11110101+ 10______
+constexpr TByte Surrogate = 1 << 4;    // 11101101 101_____
+constexpr TByte Overlong2 = 1 << 5;    // 1100000_ 10______
+constexpr TByte TooLarge1000 = 1 << 6; // 11110101+ 1000____
+constexpr TByte Overlong4 = 1 << 6;    // 11110000 1000____
+constexpr TByte TwoConts = 1 << 7;     // 10______ 10______
+constexpr TByte Carry = TooShort | TooLong | TwoConts;
+
+struct Table {
+  TByte values[16];
+};
+
+constexpr Table Byte1High{{TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TwoConts, TwoConts,
+                           TwoConts, TwoConts, TooShort | Overlong2, TooShort, TooShort | Overlong3 | Surrogate,
+                           TooShort | TooLarge | TooLarge1000 | Overlong4}};
+constexpr Table Byte1Low{{Carry | Overlong3 | Overlong2 | Overlong4, Carry | Overlong2, Carry, Carry, Carry | TooLarge,
+                          Carry | TooLarge | TooLarge1000, Carry | TooLarge | TooLarge1000,
+                          Carry | TooLarge | TooLarge1000, Carry | TooLarge | TooLarge1000,
+                          Carry | TooLarge | TooLarge1000, Carry | TooLarge | TooLarge1000,
+                          Carry | TooLarge | TooLarge1000, Carry | TooLarge | TooLarge1000,
+                          Carry | TooLarge | TooLarge1000 | Surrogate, Carry | TooLarge | TooLarge1000,
+                          Carry | TooLarge | TooLarge1000}};
+constexpr Table Byte2High{{TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort,
+                           TooLong | Overlong2 | TwoConts | Overlong3 | TooLarge1000 | Overlong4,
+                           TooLong | Overlong2 | TwoConts | Overlong3 | TooLarge,
+                           TooLong | Overlong2 | TwoConts | Surrogate | TooLarge,
+                           TooLong | Overlong2 | TwoConts | Surrogate | TooLarge, TooShort, TooShort, TooShort,
+                           TooShort}};
+
+class LookupValidator {
+  __m256i m_error;
+  __m256i m_previous;
+  __m256i m_previous_incomplete;
+
+  KL_SIMD_TARGET static __m256i lookup(const Table& table, __m256i nibbles) {
+    auto half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table.values));
+    return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(half), nibbles);
+  }
+  KL_SIMD_TARGET static __m256i high_nibbles(__m256i v) {
+    return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+  }
+  // The block shifted by N bytes, with the last N bytes of the previous block in front.
+  template <int N>
+  KL_SIMD_TARGET __m256i previous(__m256i input) const {
+    return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(m_previous, input, 0x21), 16 - N);
+  }
+  // Non-zero where the block ends inside a sequence that the next block has to complete.
+  KL_SIMD_TARGET static __m256i incomplete(__m256i input) {
+    const auto max_values = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                             -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, static_cast<char>(0xF0 - 1),
+                                             static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+    return _mm256_subs_epu8(input, max_values);
+  }
+
+public:
+  KL_SIMD_TARGET LookupValidator()
+      : m_error(_mm256_setzero_si256()), m_previous(_mm256_setzero_si256()),
+        m_previous_incomplete(_mm256_setzero_si256()) {}
+
+  KL_SIMD_TARGET void check(__m256i input) {
+    if (_mm256_movemask_epi8(input) == 0) {
+      m_error = _mm256_or_si256(m_error, m_previous_incomplete);
+    } else {
+      auto previous1 = previous<1>(input);
+      auto special_cases = _mm256_and_si256(
+          _mm256_and_si256(lookup(Byte1High, high_nibbles(previous1)),
+                           lookup(Byte1Low, _mm256_and_si256(previous1, _mm256_set1_epi8(0x0F)))),
+          lookup(Byte2High, high_nibbles(input)));
+      auto third_byte = _mm256_subs_epu8(previous<2>(input), _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+      auto fourth_byte = _mm256_subs_epu8(previous<3>(input), _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+      auto must_continue = _mm256_and_si256(_mm256_or_si256(third_byte, fourth_byte),
+                                            _mm256_set1_epi8(static_cast<char>(0x80)));
+      m_error = _mm256_or_si256(m_error, _mm256_xor_si256(must_continue, special_cases));
+      m_previous_incomplete = incomplete(input);
+    }
+    m_previous = input;
+  }
+
+  KL_SIMD_TARGET bool valid() const { return _mm256_testz_si256(m_error, m_error) != 0; }
+};
+
+KL_SIMD_TARGET bool validate(const char* begin, const char* end) {
+  LookupValidator validator;
+  auto p = begin;
+  for (; end - p >= Simd::Width; p += Simd::Width) {
+    validator.check(Simd::load(p));
+  }
+  // The tail is padded with zeros, which are ASCII; they also flag a sequence cut short by the end of the text.
+  char tail[Simd::Width] = {};
+  std::memcpy(tail, p, end - p);
+  validator.check(Simd::load(tail));
+  return validator.valid();
+}
+
+const Kernels Variant{
+    .validate = validate, .count_code_points = count_code_points, .advance = advance, .name = "avx2"};
+} // namespace
+#undef KL_SIMD_TARGET
+} // namespace avx2
+#endif
+
+const Kernels& scalar_kernels() { return Scalar; }
+
+const Kernels& sse2_kernels() {
+#ifdef KL_TEXT_SIMD_X86
+  if (__builtin_cpu_supports("sse2")) {
+    return sse2::Variant;
+  }
+#endif
+  return Scalar;
+}
+
+const Kernels& avx2_kernels() {
+#ifdef KL_TEXT_SIMD_X86
+  if (__builtin_cpu_supports("avx2")) {
+    return avx2::Variant;
+  }
+#endif
+  return sse2_kernels();
+}
+
+const Kernels& kernels() {
+  static const Kernels& selected = avx2_kernels();
+  return selected;
+}
+
+} // namespace kl::text_utf8
@@ -0,0 +1,26 @@
+#pragma once
+#include <kl/inttypes.hpp>
+
+// UTF-8 kernels used by kl::Text, selected like the search kernels: scalar, SSE2 or AVX2 depending on the CPU.
+namespace kl::text_utf8 {
+
+struct Kernels {
+  // Whether [begin, end) is well-formed UTF-8.
+  bool (*validate)(const char* begin, const char* end);
+  // Number of bytes in [begin, end) that start a code point, i.e. are not continuation bytes. For well-formed text
+  // this is the number of code points.
+  TSize (*count_code_points)(const char* begin, const char* end);
+  // Skips count code points: the start of the (count + 1)-th code point in [begin, end), or end.
+  const char* (*advance)(const char* begin, const char* end, TSize count);
+  const char* name;
+};
+
+// Each variant falls back to the next simpler one when the CPU does not support it.
+const Kernels& scalar_kernels();
+const Kernels& sse2_kernels();
+const Kernels& avx2_kernels();
+
+// The kernels for the running CPU.
+const Kernels& kernels();
+
+} // namespace kl::text_utf8
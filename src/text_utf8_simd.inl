@@ -0,0 +1,41 @@
+// UTF-8 kernels shared by the SSE2 and AVX2 variants. Included from text_utf8.cpp inside a namespace that defines
+// Simd (the vector operations) and KL_SIMD_TARGET (the target attribute applied to every function).
+
+// Bit i is set when byte i of the block starts a code point. As signed bytes, continuation bytes (0x80-0xBF) are the
+// ones not greater than 0xBF.
+KL_SIMD_TARGET uint32_t lead_mask(const char* p) {
+  return Simd::mask(Simd::gt(Simd::load(p), Simd::splat(static_cast<char>(0xBF))));
+}
+
+KL_SIMD_TARGET TSize count_code_points(const char* begin, const char* end) {
+  const auto continuation_max = Simd::splat(static_cast<char>(0xBF));
+  TSize count = 0;
+  auto p = begin;
+  while (end - p >= Simd::Width) {
+    // same byte-lane accumulation as the search count_char
+    auto blocks = std::min<ptrdiff_t>((end - p) / Simd::Width, 255);
+    auto blocks_end = p + blocks * Simd::Width;
+    auto lanes = Simd::zero();
+    for (; p < blocks_end; p += Simd::Width) {
+      lanes = Simd::sub(lanes, Simd::gt(Simd::load(p), continuation_max));
+    }
+    count += Simd::sum_bytes(lanes);
+  }
+  return count + scalar_count_code_points(p, end);
+}
+
+KL_SIMD_TARGET const char* advance(const char* begin, const char* end, TSize count) {
+  auto p = begin;
+  for (; end - p >= Simd::Width; p += Simd::Width) {
+    auto mask = lead_mask(p);
+    auto leads = std::popcount(mask);
+    if (leads > count) {
+      for (; count > 0; count--) {
+        mask &= mask - 1;
+      }
+      return p + std::countr_zero(mask);
+    }
+    count -= leads;
+  }
+  return scalar_advance(p, end, count);
+}
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include <kl/ds/algorithms.hpp>
+#include <kl/text.hpp>
+#include <atomic>
+#include <random>
+#include <string>
+
+using namespace kl;
+
+namespace {
+Array<int64_t> random_items(TSize size, int64_t range) {
+  std::mt19937_64 generator(size);
+  std::uniform_int_distribution<int64_t> distribution(0, range);
+  Array<int64_t> items(TagReserve{}, size);
+  for (TSize i = 0; i < size; i++) {
+    items.push_back(distribution(generator));
+  }
+  return items;
+}
+
+constexpr int64_t Poison = 100'000;
+
+// Counts its live copies, and refuses to copy or move the Poison value. The text makes leaks visible to sanitizers.
+struct Tracked {
+  static inline std::atomic<int64_t> live = 0;
+  int64_t value;
+  std::string text = "a payload too long to be stored inline";
+
+  Tracked() : Tracked(0) {}
+  explicit Tracked(int64_t value) : value(value) { live++; }
+  Tracked(const Tracked& other) : value(other.value), text(other.text) {
+    check();
+    live++;
+  }
+  Tracked(Tracked&& other) : value(other.value), text(std::move(other.text)) {
+    check();
+    live++;
+  }
+  Tracked& operator=(const Tracked& other) = default;
+  Tracked& operator=(Tracked&& other) = default;
+  ~Tracked() { live--; }
+
+  void check() const {
+    if (value == Poison) {
+      throw Exception("Poisoned");
+    }
+  }
+};
+} // namespace
+
+TEST(klalgorithms, task_pool) {
+  TaskPool pool(4);
+  EXPECT_EQ(pool.concurrency(), 4);
+  constexpr TSize Size = 100'003;
+  Array<int> visits(TagBuild{}, Size, 0);
+  std::atomic<TSize> ranges = 0;
+  pool.for_ranges(Size, 1000, [&](Cursor begin, Cursor end) {
+    EXPECT_EQ(begin.position() % 1000, 0);
+    EXPECT_LE(end.position() - begin.position(), 1000);
+    for (auto i = begin.position(); i < end.position(); i++) {
+      visits[i]++;
+    }
+    ranges++;
+  });
+  EXPECT_EQ(ranges, 101);
+  for (auto count: visits) {
+    ASSERT_EQ(count, 1);
+  }
+
+  std::atomic<int64_t> nested = 0;
+  pool.for_ranges(8, 1, [&](Cursor, Cursor) {
+    pool.for_ranges(1000, 10, [&](Cursor begin, Cursor end) { nested += end.position() - begin.position(); });
+  });
+  EXPECT_EQ(nested, 8000);
+
+  EXPECT_THROW(pool.for_ranges(100, 1,
+                               [](Cursor begin, Cursor) {
+                                 if (begin.position() == 57) {
+                                   throw Exception("Failed range");
+                                 }
+                               }),
+               Exception);
+  EXPECT_THROW(TaskPool(0), Exception);
+}
+
+TEST(klalgorithms, sort) {
+  TaskPool pool(4);
+  for (TSize size: {0, 1, 1000, 100'000, 333'333}) {
+    auto items = random_items(size, size / 3);
+    auto expected = items;
+    kl::sort(expected);
+    kl::sort(Parallel{pool}, items);
+    ASSERT_EQ(items.size(), expected.size());
+    for (TSize i = 0; i < size; i++) {
+      ASSERT_EQ(items[i], expected[i]);
+    }
+  }
+  auto numbers = random_items(50'000, 1'000'000);
+  Array<Text> texts(TagReserve{}, numbers.size());
+  for (auto number: numbers) {
+    texts.push_back(Text(std::to_string(number * 1'000'000).c_str()));
+  }
+  kl::sort(Parallel{pool}, texts, std::greater<>{});
+  for (TSize i = 1; i < texts.size(); i++) {
+    ASSERT_GE(texts[i - 1], texts[i]);
+  }
+}
+
+TEST(klalgorithms, transform_and_reduce) {
+  TaskPool pool(3);
+  auto items = random_items(200'001, 1000);
+  auto square = [](int64_t value) { return value * value; };
+  auto sequential = kl::transform(items, square);
+  auto parallel = kl::transform(Parallel{pool}, items, square);
+  ASSERT_EQ(parallel.size(), items.size());
+  for (TSize i = 0; i < items.size(); i++) {
+    ASSERT_EQ(parallel[i], sequential[i]);
+  }
+  auto sum = [](int64_t total, int64_t value) { return total + value; };
+  EXPECT_EQ(kl::reduce(Parallel{pool}, items, int64_t{5}, sum), kl::reduce(items, int64_t{5}, sum));
+  auto texts = kl::transform(Parallel{pool}, items, [](int64_t value) { return Text(std::to_string(value).c_str()); });
+  EXPECT_EQ(texts[-1], Text(std::to_string(items[-1]).c_str()));
+  auto longest = [](TSize size, const Text& text) { return std::max(size, text.size()); };
+  EXPECT_EQ(kl::reduce(texts, TSize{0}, longest), 4);
+  auto larger = [](TSize a, TSize b) { return std::max(a, b); };
+  EXPECT_EQ(kl::reduce(Parallel{pool}, texts, TSize{0}, longest, larger), 4);
+  // results of another type than the items, folded from an identity
+  auto total_size = [](size_t total, const Text& text) { return total + static_cast<size_t>(text.size()); };
+  EXPECT_EQ(kl::reduce(Parallel{pool}, texts, size_t{7}, total_size, std::plus<>{}),
+            kl::reduce(texts, size_t{7}, total_size));
+  auto count = [](int64_t counted, const Text&) { return counted + 1; };
+  EXPECT_EQ(kl::reduce(Parallel{pool}, texts, int64_t{0}, count, std::plus<>{}), texts.size());
+  EXPECT_EQ(kl::reduce(texts, int64_t{0}, count, std::plus<>{}), texts.size());
+  auto sum_values = [](int64_t total, int64_t value) { return total + value; };
+  Array<int> small_values(TagReserve{}, 100'000);
+  for (int i = 0; i < 100'000; i++) {
+    small_values.push_back(i % 7);
+  }
+  EXPECT_EQ(kl::reduce(Parallel{pool}, small_values, int64_t{0}, sum_values),
+            kl::reduce(small_values, int64_t{0}, sum_values));
+}
+
+TEST(klalgorithms, filter_and_partition) {
+  TaskPool pool(4);
+  auto items = random_items(150'000, 100);
+  auto even = [](int64_t value) { return value % 2 == 0; };
+  auto sequential = kl::filter(items, even);
+  auto parallel = kl::filter(Parallel{pool}, items, even);
+  ASSERT_EQ(parallel.size(), sequential.size());
+  for (TSize i = 0; i < parallel.size(); i++) {
+    ASSERT_EQ(parallel[i], sequential[i]);
+  }
+  EXPECT_EQ(kl::filter(Parallel{pool}, items, [](int64_t) { return false; }).size(), 0);
+
+  // tag each value with its position, to check that both groups keep their order
+  auto tagged = kl::transform(items, [](int64_t value) { return value; });
+  for (TSize i = 0; i < tagged.size(); i++) {
+    tagged[i] = tagged[i] * 1'000'000 + i;
+  }
+  auto tagged_even = [](int64_t value) { return (value / 1'000'000) % 2 == 0; };
+  auto expected = tagged;
+  auto expected_split = kl::partition(expected, tagged_even);
+  auto split = kl::partition(Parallel{pool}, tagged, tagged_even);
+  EXPECT_EQ(split, expected_split);
+  EXPECT_EQ(split.position(), sequential.size());
+  for (TSize i = 0; i < tagged.size(); i++) {
+    ASSERT_EQ(tagged[i], expected[i]);
+  }
+}
+
+TEST(klalgorithms, throwing_ranges) {
+  TaskPool pool(4);
+  Parallel parallel{pool};
+  constexpr TSize Size = 200'000;
+  Array<int64_t> values(TagReserve{}, Size);
+  Array<Tracked> items(TagReserve{}, Size);
+  for (TSize i = 0; i < Size; i++) {
+    values.push_back(i);
+    items.emplace_back(i);
+  }
+  auto live = Tracked::live.load();
+
+  // the results built by the other ranges are destroyed, and none of the others
+  EXPECT_THROW(kl::transform(parallel, values,
+                             [](int64_t value) {
+                               Tracked result(value);
+                               result.check();
+                               return result;
+                             }),
+               Exception);
+  EXPECT_EQ(Tracked::live, live);
+  EXPECT_THROW(kl::filter(parallel, items, [](const Tracked&) { return true; }), Exception);
+  EXPECT_EQ(Tracked::live, live);
+  auto sum = [](Tracked total, const Tracked& item) {
+    item.check();
+    return Tracked(total.value + item.value);
+  };
+  EXPECT_THROW(kl::reduce(parallel, items, Tracked(0), sum), Exception);
+  EXPECT_EQ(Tracked::live, live);
+  auto poisoned_less = [](const Tracked& a, const Tracked& b) {
+    a.check();
+    b.check();
+    return a.value < b.value;
+  };
+  EXPECT_THROW(kl::sort(parallel, items, poisoned_less), Exception);
+  EXPECT_EQ(Tracked::live, live);
+  EXPECT_THROW(kl::partition(parallel, items, [](const Tracked& item) { return item.value % 2 == 0; }), Exception);
+  EXPECT_EQ(Tracked::live, live);
+  EXPECT_EQ(items.size(), Size);
+}
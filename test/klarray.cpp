@@ -1,5 +1,10 @@
 #include <gtest/gtest.h>
 #include <kl/ds/array.hpp>
+#include <kl/ds/pair.hpp>
+#include <kl/memory.hpp>
+#include <kl/text.hpp>
+#include <cstdlib>
+#include <string>
 
 using namespace kl;
 
@@ -48,3 +53,153 @@ TEST(klarray, reallocation) {
   EXPECT_EQ(a.size(), 33);
   EXPECT_EQ(a.reserved(), 64);
 }
+
+TEST(klarray, emplace_and_move) {
+  Array<Pair<int, int>> a;
+  a.emplace_back(1, 2);
+  EXPECT_EQ(a[0].first, 1);
+  EXPECT_EQ(a[0].second, 2);
+  Array<UniquePointer<int>> b;
+  auto ptr = make_ptr<int>(10);
+  b.push_back(std::move(ptr));
+  EXPECT_EQ(ptr.get(), nullptr);
+  EXPECT_EQ(*b[0], 10);
+}
+
+TEST(klarray, insert_and_remove) {
+  Array<UniquePointer<int>> a;
+  a.insert(0, make_ptr<int>(2));
+  a.insert(0, make_ptr<int>(0));
+  a.insert(1, make_ptr<int>(1));
+  a.insert(3, make_ptr<int>(3));
+  EXPECT_EQ(a.size(), 4);
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(*a[i], i);
+  }
+  EXPECT_THROW(a.insert(5, make_ptr<int>(5)), Exception);
+  a.remove_at(1);
+  a.remove_at(-1);
+  EXPECT_EQ(a.size(), 2);
+  EXPECT_EQ(*a[0], 0);
+  EXPECT_EQ(*a[1], 2);
+  EXPECT_THROW(a.remove_at(2), Exception);
+  a.clear();
+  EXPECT_EQ(a.size(), 0);
+  EXPECT_EQ(a.reserved(), 8);
+}
+
+static_assert(is_trivially_relocatable<int>);
+static_assert(is_trivially_relocatable<Pair<int, UniquePointer<int>>>);
+static_assert(is_trivially_relocatable<Array<Text>>);
+static_assert(!is_trivially_relocatable<Pair<int, std::string>>);
+
+TEST(klarray, relocation) {
+  // heap texts, whose reference counts would show any item moved twice or not destroyed
+  Array<Text> a;
+  std::string value(40, 'x');
+  for (int i = 0; i < 100; i++) {
+    value[0] = static_cast<char>('0' + i % 10);
+    a.push_back(Text(value.data(), static_cast<TSize>(value.size())));
+  }
+  auto copy = a[5];
+  a.insert(0, copy);
+  a.insert(50, "middle"_t);
+  a.remove_at(1);
+  a.reserve(1000);
+  EXPECT_EQ(a.size(), 101);
+  EXPECT_EQ(a[0], copy);
+  EXPECT_EQ(a[49], "middle"_t);
+  EXPECT_EQ(a[-1][0], '9');
+  EXPECT_EQ(a[1][0], '1');
+
+  Array<std::string> b;
+  for (int i = 0; i < 20; i++) {
+    b.insert(0, std::to_string(i));
+  }
+  b.remove_at(0);
+  EXPECT_EQ(b[0], "18");
+  EXPECT_EQ(b[-1], "0");
+}
+
+TEST(klarray, block_growth) {
+  // grows through realloc'd blocks into mapped ones, past MappedBlockSize
+  Array<int64_t> a;
+  constexpr TSize Count = 3 * MappedBlockSize / sizeof(int64_t);
+  for (TSize i = 0; i < Count; i++) {
+    a.push_back(i);
+  }
+  EXPECT_GE(a.reserved() * sizeof(int64_t), 2 * MappedBlockSize);
+  for (TSize i = 0; i < Count; i += 4099) {
+    ASSERT_EQ(a[i], i);
+  }
+  EXPECT_EQ(a[-1], Count - 1);
+  a.insert(0, -1);
+  a.remove_at(1);
+  EXPECT_EQ(a[0], -1);
+  EXPECT_EQ(a[1], 1);
+  auto copy = a;
+  EXPECT_EQ(copy[-1], Count - 1);
+
+  Array<int64_t> reserved(TagReserve{}, Count);
+  reserved.push_back(7);
+  EXPECT_EQ(reserved[0], 7);
+  Array<int> empty(TagReserve{}, 0);
+  empty.push_back(1);
+  EXPECT_EQ(empty.size(), 1);
+}
+
+namespace {
+// Counts the blocks it hands out; it cannot grow them, so arrays reallocate.
+struct CountingResource {
+  TSize* live;
+  void* allocate(size_t bytes) {
+    ++*live;
+    return std::malloc(bytes);
+  }
+  void release(void* block, size_t) {
+    --*live;
+    std::free(block);
+  }
+};
+
+struct CountingDynamicResource : DynamicResource {
+  TSize allocations = 0;
+  void* allocate(size_t bytes) override {
+    allocations++;
+    return std::malloc(bytes);
+  }
+  void release(void* block, size_t) override { std::free(block); }
+};
+} // namespace
+
+TEST(klarray, resources) {
+  static_assert(sizeof(Array<int>) == sizeof(int*) + 2 * sizeof(TSize));
+  static_assert(is_trivially_relocatable<Array<Text, CountingResource>>);
+  TSize live = 0;
+  {
+    Array<Text, CountingResource> a(CountingResource{&live});
+    for (TSize i = 0; i < 100; i++) {
+      a.push_back(Text(std::to_string(i * 1000000).c_str()));
+    }
+    EXPECT_EQ(live, 1);
+    auto copy = a;
+    EXPECT_EQ(live, 2);
+    EXPECT_EQ(copy.resource().live, &live);
+    Array<Text, CountingResource> moved(std::move(copy));
+    EXPECT_EQ(live, 2);
+    EXPECT_EQ(moved[-1], "99000000"_t);
+    Array<std::string, CountingResource> strings(TagReserve{}, 2, CountingResource{&live});
+    strings.push_back(std::string(40, 'x'));
+    strings.insert(0, std::string(40, 'y'));
+    strings.push_back("z");
+    EXPECT_EQ(strings[0], std::string(40, 'y'));
+    EXPECT_EQ(live, 3);
+  }
+  EXPECT_EQ(live, 0);
+
+  CountingDynamicResource counting;
+  Array<int, ResourceRef> ints({1, 2, 3}, counting);
+  ints.push_back(4);
+  EXPECT_EQ(counting.allocations, 2);
+  EXPECT_EQ(ints[-1], 4);
+}
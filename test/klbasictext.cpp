@@ -1,5 +1,10 @@
 #include <gtest/gtest.h>
 #include "kl/text.hpp"
+#include "kl/text/arena.hpp"
+#include "kl/text/intern.hpp"
+#include <string>
+#include <thread>
+#include <vector>
 using namespace kl;
 
 TEST(klbasictext, textref) {
@@ -38,3 +43,300 @@ TEST(klbasictext, text_construction) {
   Text t10("  1  Hello world", 5);
   EXPECT_EQ(t10.size(), 5);
 }
+
+TEST(klbasictext, small_text) {
+  EXPECT_EQ(sizeof(Text), 16);
+  auto is_inline = [](const Text& t) {
+    auto object = reinterpret_cast<const char*>(&t);
+    return t.begin() >= object && t.begin() < object + sizeof(Text);
+  };
+  Text t1("Hello world, 15");
+  EXPECT_EQ(t1.size(), 15);
+  EXPECT_TRUE(is_inline(t1));
+  EXPECT_EQ(t1.to_view(), "Hello world, 15");
+  Text t2("Hello world, 16!");
+  EXPECT_EQ(t2.size(), 16);
+  EXPECT_FALSE(is_inline(t2));
+  EXPECT_EQ(t2.to_view(), "Hello world, 16!");
+  Text t3 = 'x';
+  EXPECT_TRUE(is_inline(t3));
+  EXPECT_EQ(t3.to_view(), "x");
+  EXPECT_FALSE(is_inline(""_t));
+
+  Text copy = t1;
+  EXPECT_TRUE(is_inline(copy));
+  EXPECT_NE(copy.begin(), t1.begin());
+  EXPECT_EQ(copy.to_view(), t1.to_view());
+  Text moved = std::move(copy);
+  EXPECT_EQ(moved.to_view(), "Hello world, 15");
+  EXPECT_EQ(copy.size(), 0); // NOLINT(bugprone-use-after-move)
+
+  moved = t2;
+  EXPECT_EQ(moved.begin(), t2.begin());
+  EXPECT_EQ(moved.to_view(), "Hello world, 16!");
+  moved = t3;
+  EXPECT_EQ(moved.to_view(), "x");
+  moved = std::move(t2);
+  EXPECT_EQ(moved.to_view(), "Hello world, 16!");
+  EXPECT_EQ(t2.size(), 0); // NOLINT(bugprone-use-after-move)
+}
+
+TEST(klbasictext, shared_text) {
+  auto refcount = [](const Text& t) {
+    return TextRefCountedBase::from_text_address(const_cast<char*>(t.begin()))->refcount;
+  };
+  EXPECT_TRUE("A literal is always shared"_t.is_shared());
+  EXPECT_TRUE(Text("small").is_shared());
+
+  Text local("A text that is long enough for a buffer");
+  EXPECT_FALSE(local.is_shared());
+  Text copy = local;
+  Text shared = local.shared();
+  EXPECT_TRUE(shared.is_shared());
+  EXPECT_FALSE(local.is_shared());
+  EXPECT_NE(shared.begin(), local.begin());
+  EXPECT_EQ(shared.to_view(), local.to_view());
+
+  Text sole("Another text that is long enough for a buffer", 45, TextSharing::Local);
+  Text promoted = sole.shared();
+  EXPECT_EQ(promoted.begin(), sole.begin());
+  EXPECT_TRUE(sole.is_shared());
+  EXPECT_EQ(refcount(sole), 2);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; i++) {
+    threads.emplace_back([&shared]() {
+      std::vector<Text> copies;
+      for (int j = 0; j < 10000; j++) {
+        copies.push_back(shared);
+      }
+    });
+  }
+  for (auto& thread: threads) {
+    thread.join();
+  }
+  EXPECT_EQ(refcount(shared), 1);
+}
+
+TEST(klbasictext, arena_text) {
+  TextArena arena(4096);
+  EXPECT_EQ(arena.used_bytes(), 0);
+  const char* payload = "This text lives in the arena until reset";
+  Text copy;
+  Text assigned;
+  Text shared;
+  {
+    Text small("short", 5, arena);
+    EXPECT_EQ(arena.used_bytes(), 0);
+    EXPECT_EQ(small.to_view(), "short");
+
+    Text t1(payload, 40, arena);
+    Text t2(payload, 30, arena);
+    EXPECT_EQ(t1.to_view(), std::string_view(payload, 40));
+    EXPECT_EQ(t2.to_view(), std::string_view(payload, 30));
+    EXPECT_GT(arena.used_bytes(), 70);
+    EXPECT_FALSE(t1.is_shared());
+    auto header = TextRefCountedBase::from_text_address(const_cast<char*>(t1.begin()));
+    EXPECT_TRUE(header->is_arena());
+    EXPECT_EQ(header->refcount, RefCountedGuard);
+
+    Text moved = std::move(t1);
+    EXPECT_EQ(TextRefCountedBase::from_text_address(const_cast<char*>(moved.begin())), header);
+
+    copy = moved;
+    EXPECT_NE(copy.begin(), moved.begin());
+    EXPECT_FALSE(TextRefCountedBase::from_text_address(const_cast<char*>(copy.begin()))->is_arena());
+    assigned = t2;
+    EXPECT_NE(assigned.begin(), t2.begin());
+    shared = t2.shared();
+    EXPECT_TRUE(shared.is_shared());
+
+    Text large(std::string(10000, 'x').c_str(), 10000, arena);
+    EXPECT_EQ(large.size(), 10000);
+    Text after_large(payload, 40, arena);
+    EXPECT_EQ(after_large.to_view(), std::string_view(payload, 40));
+  }
+
+  arena.reset();
+  EXPECT_EQ(arena.used_bytes(), 0);
+  EXPECT_EQ(copy.to_view(), std::string_view(payload, 40));
+  EXPECT_EQ(assigned.to_view(), std::string_view(payload, 30));
+  EXPECT_EQ(shared.to_view(), std::string_view(payload, 30));
+  Text reused(payload, 40, arena);
+  EXPECT_EQ(reused.to_view(), std::string_view(payload, 40));
+}
+
+TEST(klbasictext, interning) {
+  TextInternTable table;
+  Text source("metric.cpu.load.average on host-0042");
+  auto first = table.intern(source);
+  auto second = table.intern(Text("metric.cpu.load.average on host-0042"));
+  auto third = table.intern(std::string_view("metric.cpu.load.average on host-0042"));
+  EXPECT_EQ(first.begin(), second.begin());
+  EXPECT_EQ(first.begin(), third.begin());
+  EXPECT_NE(first.begin(), source.begin());
+  EXPECT_TRUE(first.is_shared());
+  EXPECT_EQ(first, source);
+  EXPECT_EQ(table.size(), 1);
+
+  auto slice = table.intern(source.sublen(7, 15));
+  EXPECT_EQ(slice.to_view(), "cpu.load.averag");
+  EXPECT_EQ(table.size(), 1);
+  auto literal = "a literal that is interned as it is"_t;
+  EXPECT_EQ(table.intern(literal).begin(), literal.begin());
+  EXPECT_EQ(intern(source).begin(), intern(source.sublen(0, source.size())).begin());
+
+  std::vector<std::thread> threads;
+  std::vector<Text> results(8);
+  for (int i = 0; i < 8; i++) {
+    threads.emplace_back([&table, &results, i]() {
+      for (int j = 0; j < 1000; j++) {
+        auto value = std::string("concurrently interned text #") + std::to_string(j);
+        table.intern(Text(value.data(), static_cast<TSize>(value.size())));
+      }
+      results[i] = table.intern(std::string_view("concurrently interned text #500"));
+    });
+  }
+  for (auto& thread: threads) {
+    thread.join();
+  }
+  EXPECT_EQ(table.size(), 1002);
+  for (const auto& result: results) {
+    EXPECT_EQ(result.begin(), results[0].begin());
+  }
+}
+
+TEST(klbasictext, weak_interning) {
+  TextInternTable table(InternMode::Weak, 4);
+  auto kept = table.intern(std::string_view("a text that is still referenced"));
+  table.intern(std::string_view("a text that nobody references anymore"));
+  EXPECT_EQ(table.size(), 2);
+  table.sweep();
+  EXPECT_EQ(table.size(), 1);
+  EXPECT_EQ(table.intern(std::string_view("a text that is still referenced")).begin(), kept.begin());
+  for (int i = 0; i < 1000; i++) {
+    table.intern(std::string("short lived interned text #") + std::to_string(i));
+  }
+  EXPECT_LT(table.size(), 1000);
+}
+
+static_assert(TextLiteral("compile-time hash").base.hash == hash_bytes("compile-time hash", 17));
+
+TEST(klbasictext, hashing) {
+  // wyhash reference values
+  EXPECT_EQ(hash_bytes("", 0, 0), 0x93228a4de0eec5a2ull);
+  EXPECT_EQ(hash_bytes("abc", 3, 2), 0xa97f2f7b1d9b3314ull);
+  EXPECT_EQ(hash_bytes("abcdefghijklmnopqrstuvwxyz", 26, 4), 0xdca5a8138ad37c87ull);
+  std::string_view long_value("12345678901234567890123456789012345678901234567890123456789012345678901234567890");
+  EXPECT_EQ(hash_bytes(long_value.data(), long_value.size(), 6), 0x6cc5eab49a92d617ull);
+
+  auto literal = "/usr/share/applications/org.example.Viewer.desktop"_t;
+  Text copy(literal.begin(), literal.size());
+  Text shared(literal.begin(), literal.size(), TextSharing::Shared);
+  auto expected = hash_bytes(literal.begin(), literal.size());
+  EXPECT_EQ(literal.hash(), expected);
+  EXPECT_EQ(copy.hash(), expected);
+  EXPECT_EQ(copy.hash(), expected); // cached
+  EXPECT_EQ(shared.hash(), expected);
+  EXPECT_EQ(std::hash<Text>{}(copy), expected);
+
+  auto slice = copy.skip(5);
+  EXPECT_EQ(slice.hash(), hash_bytes(copy.begin() + 5, copy.size() - 5));
+  EXPECT_EQ(slice.hash(), Text(slice.begin(), slice.size()).hash());
+  auto small = copy.sublen(0, 10);
+  EXPECT_EQ(small.hash(), hash_bytes("/usr/share", 10));
+
+  TextArena arena;
+  {
+    Text in_arena(literal.begin(), literal.size(), arena);
+    EXPECT_EQ(in_arena.hash(), expected);
+    EXPECT_EQ(in_arena.hash(), expected);
+  }
+}
+
+namespace {
+struct TrackingResource : DynamicResource {
+  TSize live = 0;
+  void* allocate(size_t bytes) override {
+    live++;
+    return ::operator new(bytes);
+  }
+  void release(void* block, size_t) override {
+    live--;
+    ::operator delete(block);
+  }
+};
+
+// Frees all its blocks at once when destroyed, like a monotonic buffer.
+struct BulkResource : DynamicResource {
+  std::vector<void*> blocks;
+  ~BulkResource() override {
+    for (auto block: blocks) {
+      ::operator delete(block);
+    }
+  }
+  void* allocate(size_t bytes) override { return blocks.emplace_back(::operator new(bytes)); }
+  void release(void*, size_t) override {}
+};
+} // namespace
+
+TEST(klbasictext, resource_scope) {
+  TrackingResource resource;
+  Text heap_text;
+  {
+    Text scoped;
+    {
+      TextResourceScope scope(resource);
+      EXPECT_EQ(TextResourceScope::current(), &resource);
+      scoped = Text(std::string(100, 'r').c_str());
+      Text small("inline");
+      EXPECT_EQ(resource.live, 1);
+      TrackingResource nested;
+      {
+        TextResourceScope inner(nested);
+        Text other(std::string(50, 'n').c_str());
+        EXPECT_EQ(nested.live, 1);
+      }
+      EXPECT_EQ(nested.live, 0);
+      EXPECT_EQ(TextResourceScope::current(), &resource);
+    }
+    EXPECT_EQ(TextResourceScope::current(), nullptr);
+    heap_text = Text(std::string(100, 'h').c_str());
+    EXPECT_EQ(resource.live, 1);
+    auto shared = scoped.shared();
+    auto slice = scoped.sublen(10, 50);
+    scoped = {};
+    EXPECT_EQ(resource.live, 1);
+    EXPECT_EQ(slice.size(), 50);
+    EXPECT_EQ(shared.size(), 100);
+  }
+  EXPECT_EQ(resource.live, 0);
+  EXPECT_EQ(heap_text.size(), 100);
+}
+
+TEST(klbasictext, resource_scope_outliving_copies) {
+  TextInternTable table;
+  TextArena arena;
+  std::string payload(80, 'p');
+  Text in_arena(payload.data(), 80, arena);
+  Text interned;
+  Text shared;
+  Text promoted;
+  {
+    BulkResource resource;
+    TextResourceScope scope(resource);
+    Text scoped(payload.c_str());
+    EXPECT_EQ(resource.blocks.size(), 1);
+    interned = table.intern(scoped);
+    auto owner = scoped;
+    shared = scoped.shared();
+    promoted = in_arena;
+    EXPECT_EQ(resource.blocks.size(), 1);
+  }
+  // the resource and its blocks are gone, the copies are on the heap
+  EXPECT_EQ(interned.to_view(), payload);
+  EXPECT_EQ(table.intern(std::string_view(payload)).begin(), interned.begin());
+  EXPECT_EQ(shared.to_view(), payload);
+  EXPECT_EQ(promoted.to_view(), payload);
+  EXPECT_NE(promoted.begin(), in_arena.begin());
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <kl/ds/concurrent_dict.hpp>
+#include <kl/text.hpp>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace kl;
+
+TEST(klconcurrentdict, basic_operations) {
+  ConcurrentDict<Text, int> d(3);
+  EXPECT_EQ(d.shard_count(), 4);
+  using IntDict = ConcurrentDict<int, int>;
+  EXPECT_GE(IntDict().shard_count(), 4);
+  EXPECT_THROW(IntDict(0), Exception);
+
+  d.add("alpha", 1);
+  d.add("beta"_t, 2);
+  d.add(std::string_view("epsilon"), 3);
+  EXPECT_EQ(d.size(), 3);
+  EXPECT_EQ(d.get("epsilon"_t), 3);
+  EXPECT_TRUE(d.remove(std::string("epsilon")));
+  EXPECT_EQ(d.size(), 2);
+  EXPECT_TRUE(d.has("alpha"));
+  EXPECT_EQ(d.get("beta"), 2);
+  EXPECT_EQ(d.get("gamma", -1), -1);
+  EXPECT_EQ(d.get_opt(std::string_view("alpha")), 1);
+
+  int calls = 0;
+  EXPECT_EQ(d.get_or_insert("alpha", [&] { return ++calls; }), 1);
+  EXPECT_EQ(d.get_or_insert("gamma", [&] { return ++calls + 10; }), 11);
+  EXPECT_EQ(calls, 1);
+
+  EXPECT_TRUE(d.update("gamma", [](int& value) { value *= 2; }));
+  EXPECT_FALSE(d.update("delta", [](int& value) { value *= 2; }));
+  EXPECT_EQ(d.get("gamma"), 22);
+
+  int sum = 0;
+  d.for_each([&](const Text&, int value) { sum += value; });
+  EXPECT_EQ(sum, 1 + 2 + 22);
+
+  EXPECT_TRUE(d.remove("alpha"));
+  EXPECT_FALSE(d.has("alpha"));
+  d.clear();
+  EXPECT_EQ(d.size(), 0);
+}
+
+TEST(klconcurrentdict, concurrent_updates) {
+  constexpr int Threads = 8;
+  constexpr int Keys = 64;
+  constexpr int Rounds = 2000;
+  ConcurrentDict<int, int> counters(16);
+  std::atomic<int> created{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < Threads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < Rounds; i++) {
+        auto key = (i + t) % Keys;
+        counters.get_or_insert(key, [&] {
+          created++;
+          return 0;
+        });
+        counters.update(key, [](int& value) { value++; });
+      }
+    });
+  }
+  for (auto& thread: threads) {
+    thread.join();
+  }
+  EXPECT_EQ(created, Keys);
+  EXPECT_EQ(counters.size(), Keys);
+  int total = 0;
+  counters.for_each([&](int, int value) { total += value; });
+  EXPECT_EQ(total, Threads * Rounds);
+}
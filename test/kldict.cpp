@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <kl/ds/dict.hpp>
+#include <kl/text.hpp>
+#include <map>
+#include <random>
+#include <string>
+
+using namespace kl;
+
+TEST(kldict, basic_operations) {
+  Dict<int, int> d;
+  EXPECT_EQ(d.size(), 0);
+  EXPECT_FALSE(d.has(1));
+  EXPECT_EQ(d.get(1, -1), -1);
+  EXPECT_EQ(d.get_opt(1), std::nullopt);
+  EXPECT_THROW(d[1], Exception);
+
+  d.add(1, 10);
+  d.add(2, 20);
+  d.add(1, 11);
+  EXPECT_EQ(d.size(), 2);
+  EXPECT_EQ(d[1], 11);
+  EXPECT_EQ(d.get(2, -1), 20);
+  EXPECT_EQ(d.get_opt(2), 20);
+  d[2] = 21;
+  EXPECT_EQ(*d.find(2), 21);
+
+  EXPECT_TRUE(d.remove(1));
+  EXPECT_FALSE(d.remove(1));
+  EXPECT_FALSE(d.has(1));
+  EXPECT_EQ(d.size(), 1);
+  EXPECT_EQ(d.keys().size(), 1);
+  EXPECT_EQ(d.values()[0], 21);
+
+  d.clear();
+  EXPECT_EQ(d.size(), 0);
+  EXPECT_FALSE(d.has(2));
+  d.add(3, 30);
+  EXPECT_EQ(d[3], 30);
+
+  Dict<int, int> e{{1, 2}, {3, 4}, {1, 5}};
+  EXPECT_EQ(e.size(), 2);
+  EXPECT_EQ(e[1], 5);
+}
+
+TEST(kldict, matches_std_map) {
+  // random inserts, overwrites and removals, with enough churn to fill the table with deleted slots
+  Dict<int, int> d;
+  std::map<int, int> expected;
+  std::mt19937 rng(7);
+  for (int round = 0; round < 200'000; round++) {
+    int key = static_cast<int>(rng() % 5000);
+    if (rng() % 3 == 0) {
+      ASSERT_EQ(d.remove(key), expected.erase(key) == 1);
+    } else {
+      d.add(key, round);
+      expected[key] = round;
+    }
+  }
+  ASSERT_EQ(d.size(), static_cast<TSize>(expected.size()));
+  TSize visited = 0;
+  for (const auto& [key, value]: d) {
+    ASSERT_EQ(expected.at(key), value);
+    visited++;
+  }
+  EXPECT_EQ(visited, d.size());
+  EXPECT_LE(d.capacity(), 16384);
+  for (int key = 0; key < 5000; key++) {
+    ASSERT_EQ(d.has(key), expected.contains(key));
+  }
+}
+
+TEST(kldict, text_keys) {
+  Dict<Text, int> d;
+  for (int i = 0; i < 1000; i++) {
+    auto key = "key number " + std::to_string(i);
+    d.add(Text(key.data(), static_cast<TSize>(key.size())), i);
+  }
+  d.add("short", -1);
+  EXPECT_EQ(d.size(), 1001);
+
+  // lookups by views and C strings hash the same bytes as the Text keys
+  EXPECT_EQ(d["key number 42"], 42);
+  EXPECT_EQ(d[std::string_view("key number 999")], 999);
+  std::string name = "key number 7";
+  EXPECT_EQ(d.get(name.c_str(), -2), 7);
+  EXPECT_EQ(d[Text("short")], -1);
+  EXPECT_EQ(d["short"_t], -1);
+  EXPECT_FALSE(d.has("key number 1000"));
+  EXPECT_TRUE(d.remove("key number 0"));
+  EXPECT_FALSE(d.has("key number 0"_t));
+  d.add("key number 1", 100);
+  EXPECT_EQ(d["key number 1"], 100);
+  EXPECT_EQ(d.size(), 1000);
+  // views and strings are copied into new Text keys
+  d.add(std::string_view("key number 1000"), 1000);
+  d.add(std::string("key number 1001"), 1001);
+  EXPECT_EQ(d["key number 1000"_t], 1000);
+  EXPECT_EQ(d["key number 1001"], 1001);
+  EXPECT_TRUE(d.remove("key number 1000"));
+  EXPECT_TRUE(d.remove("key number 1001"));
+  EXPECT_EQ(d.size(), 1000);
+
+  auto copy = d;
+  d.clear();
+  EXPECT_EQ(copy.size(), 1000);
+  EXPECT_EQ(copy["key number 500"], 500);
+  Dict<Text, int> moved = std::move(copy);
+  EXPECT_EQ(moved["short"], -1);
+  EXPECT_EQ(copy.size(), 0);
+}
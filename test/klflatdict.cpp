@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <kl/ds/flat_dict.hpp>
+#include <kl/text.hpp>
+#include <map>
+#include <random>
+#include <string>
+
+using namespace kl;
+
+TEST(klflatdict, bulk_build) {
+  Array<Pair<Text, int>> items{{"content-type"_t, 1}, {"accept"_t, 2}, {"host"_t, 3}, {"accept"_t, 4}};
+  FlatDict<Text, int> headers(std::move(items));
+  EXPECT_EQ(headers.size(), 3);
+  EXPECT_EQ(headers.keys()[0], "accept"_t);
+  EXPECT_EQ(headers.keys()[-1], "host"_t);
+  EXPECT_EQ(headers["accept"], 4); // the last of the repeated keys
+  EXPECT_EQ(headers[std::string_view("host")], 3);
+  EXPECT_EQ(headers.get("content-type"_t, 0), 1);
+  EXPECT_FALSE(headers.has("cookie"));
+  EXPECT_EQ(headers.get_opt("cookie"), std::nullopt);
+  EXPECT_THROW(headers["cookie"], Exception);
+  // views and strings are copied into new Text keys
+  headers.add(std::string_view("cookie"), 5);
+  headers.add(std::string("accept"), 6);
+  EXPECT_EQ(headers.size(), 4);
+  EXPECT_EQ(headers["cookie"_t], 5);
+  EXPECT_EQ(headers["accept"], 6);
+
+  TSize visited = 0;
+  for (auto [key, value]: headers) {
+    EXPECT_EQ(headers[key], value);
+    visited++;
+  }
+  EXPECT_EQ(visited, 4);
+
+  FlatDict<int, int> empty;
+  EXPECT_FALSE(empty.has(1));
+  FlatDict<int, int> listed{{3, 30}, {1, 10}, {2, 20}};
+  EXPECT_EQ(listed.values()[0], 10);
+  EXPECT_EQ(listed.values()[2], 30);
+}
+
+TEST(klflatdict, matches_std_map) {
+  FlatDict<int, int> d;
+  std::map<int, int> expected;
+  std::mt19937 rng(11);
+  for (int round = 0; round < 20'000; round++) {
+    int key = static_cast<int>(rng() % 300);
+    if (rng() % 3 == 0) {
+      ASSERT_EQ(d.remove(key), expected.erase(key) == 1);
+    } else {
+      d.add(key, round);
+      expected[key] = round;
+    }
+  }
+  ASSERT_EQ(d.size(), static_cast<TSize>(expected.size()));
+  TSize index = 0;
+  for (const auto& [key, value]: expected) {
+    ASSERT_EQ(d.keys()[index], key);
+    ASSERT_EQ(d.values()[index], value);
+    index++;
+  }
+  for (int key = -1; key <= 300; key++) {
+    ASSERT_EQ(d.has(key), expected.contains(key));
+  }
+  d.clear();
+  EXPECT_EQ(d.size(), 0);
+}
@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+#include <kl/io/posix.hpp>
+#include <kl/except.hpp>
+#include <climits>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+using namespace kl;
+
+TEST(klio, write_all_gathers_buffers) {
+  std::vector<std::string> pieces;
+  std::string expected;
+  for (int i = 0; i < IOV_MAX * 2 + 17; i++) {
+    pieces.push_back(std::to_string(i));
+    pieces.emplace_back();
+    pieces.push_back(std::string(i % 100, 'x') + ",");
+    expected += pieces[pieces.size() - 3] + pieces.back();
+  }
+  std::vector<iovec> parts;
+  for (auto& piece: pieces) {
+    parts.push_back({.iov_base = piece.data(), .iov_len = piece.size()});
+  }
+
+  // more data than the pipe holds, drained by another thread in small reads
+  int fds[2];
+  ASSERT_EQ(::pipe(fds), 0);
+  std::string received;
+  std::thread reader([&] {
+    char buffer[1000];
+    ssize_t bytes;
+    while ((bytes = ::read(fds[0], buffer, sizeof(buffer))) > 0) {
+      received.append(buffer, static_cast<size_t>(bytes));
+    }
+  });
+  posix::write_all(fds[1], parts);
+  ::close(fds[1]);
+  reader.join();
+  ::close(fds[0]);
+  EXPECT_EQ(received.size(), expected.size());
+  EXPECT_EQ(received, expected);
+  EXPECT_THROW(posix::write_all(-1, parts), Exception);
+}
@@ -1,5 +1,10 @@
 #include <kl/memory.hpp>
+#include <kl/ds/array.hpp>
+#include <kl/text.hpp>
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
 
 static const int CANARY_VALUE = -5555;
 static int object_count = 0;
@@ -216,6 +221,21 @@ TEST_F(KLMem, test_ref_counted_pointer_2) {
   }
   ASSERT_EQ(deletion_count, 1);
   ASSERT_EQ(object_count, 0);
+
+  // assigning a pointer held by the value being released
+  struct Node {
+    kl::ShareableMutablePointer<Node> next = nullptr;
+  };
+  auto head = kl::make_mutable_shareable<Node>();
+  head->next = kl::make_mutable_shareable<Node>();
+  head = head->next;
+  ASSERT_EQ(get_reference_count<Node>(&(*head)), 1);
+  ASSERT_THROW(head->next->next, kl::Exception);
+  // and moving it
+  head->next = kl::make_mutable_shareable<Node>();
+  head = std::move(head->next);
+  ASSERT_EQ(get_reference_count<Node>(&(*head)), 1);
+  ASSERT_THROW(head->next->next, kl::Exception);
 }
 
 TEST_F(KLMem, test_shareable_pointer_2) {
@@ -309,4 +329,359 @@ TEST_F(KLMem, shared_array_tests) {
       ASSERT_EQ(ptr2.size(), 0);
     }
   }
+
+  // assigning a pointer held by an item of the array being released
+  struct Node {
+    kl::SharedArrayPointer<Node> next{0};
+  };
+  kl::SharedArrayPointer<Node> nodes(2);
+  nodes[1].next = kl::SharedArrayPointer<Node>(3);
+  nodes = nodes[1].next;
+  ASSERT_EQ(nodes.size(), 3);
+  ASSERT_EQ(nodes[2].next.size(), 0);
+  // and moving it
+  nodes[0].next = kl::SharedArrayPointer<Node>(4);
+  nodes = std::move(nodes[0].next);
+  ASSERT_EQ(nodes.size(), 4);
+  ASSERT_EQ(nodes[3].next.get(), nullptr);
+}
+
+TEST_F(KLMem, atomic_shareable_pointers) {
+  auto mutable_ptr = kl::make_atomic_mutable_shareable<A>(1);
+  auto ptr = kl::make_atomic_shareable<A>(2);
+  kl::AtomicSharedArrayPointer<A> array(10);
+  ASSERT_EQ(creation_count, 12);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; t++) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 10000; i++) {
+        auto mutable_copy = mutable_ptr;
+        kl::AtomicShareablePointer<A> copy(ptr);
+        auto array_copy = array;
+        mutable_copy = std::move(mutable_copy);
+      }
+    });
+  }
+  for (auto& thread: threads) {
+    thread.join();
+  }
+  ASSERT_EQ(deletion_count, 0);
+  auto counted = kl::RefCountedValue<A, kl::RefCounting::Atomic>::from_pointer(&(*mutable_ptr));
+  ASSERT_EQ(counted->reference_count.load(), 1);
+  array = nullptr;
+  ASSERT_EQ(deletion_count, 10);
+  mutable_ptr.reset();
+  ASSERT_EQ(deletion_count, 11);
+}
+
+TEST_F(KLMem, ref_counted_value_alignment) {
+  struct alignas(16) Wide {
+    double value;
+  };
+  auto ptr = kl::make_mutable_shareable<Wide>(Wide{2.5});
+  auto copy = ptr;
+  ASSERT_EQ(kl::RefCountedValue<Wide>::from_pointer(&(*copy))->reference_count, 2);
+  ASSERT_EQ(copy->value, 2.5);
+  using AtomicDouble = kl::RefCountedValue<double, kl::RefCounting::Atomic>;
+  auto atomic_ptr = kl::make_atomic_mutable_shareable<double>(1.5);
+  ASSERT_EQ(AtomicDouble::from_pointer(&(*atomic_ptr))->reference_count.load(), 1);
+}
+
+TEST_F(KLMem, weak_pointer) {
+  kl::WeakPointer<A> empty;
+  EXPECT_TRUE(empty.expired());
+  EXPECT_THROW(empty.lock()->foo(), kl::Exception);
+  kl::WeakPointer<A> weak;
+  {
+    auto ptr = kl::make_mutable_shareable<A>(1);
+    weak = ptr;
+    EXPECT_FALSE(weak.expired());
+    auto counted = kl::RefCountedValue<A>::from_pointer(&(*ptr));
+    EXPECT_EQ(counted->reference_count, 1);
+    EXPECT_EQ(counted->weak_count, 2);
+    {
+      auto locked = weak.lock();
+      EXPECT_EQ(&(*locked), &(*ptr));
+      EXPECT_EQ(counted->reference_count, 2);
+      kl::WeakPointer<A> copy = weak;
+      kl::WeakPointer<A> moved = std::move(copy);
+      EXPECT_EQ(counted->weak_count, 3);
+    }
+    EXPECT_EQ(counted->reference_count, 1);
+    EXPECT_EQ(deletion_count, 0);
+  }
+  EXPECT_EQ(deletion_count, 1);
+  EXPECT_TRUE(weak.expired());
+  EXPECT_THROW(weak.lock()->foo(), kl::Exception);
+  weak.reset();
+
+  // the block outlives the value until the last weak pointer goes
+  auto held = kl::WeakPointer<A>(kl::make_shareable<A>(2));
+  EXPECT_EQ(deletion_count, 2);
+  EXPECT_TRUE(held.expired());
+}
+
+TEST_F(KLMem, atomic_weak_pointer) {
+  for (int round = 0; round < 20; round++) {
+    auto ptr = kl::make_atomic_mutable_shareable<A>(1);
+    kl::AtomicWeakPointer<A> weak(ptr);
+    std::vector<std::thread> threads;
+    std::atomic<int> locked = 0;
+    for (int t = 0; t < 4; t++) {
+      threads.emplace_back([&] {
+        for (int i = 0; i < 1000; i++) {
+          auto copy = weak;
+          try {
+            auto strong = copy.lock();
+            EXPECT_EQ(strong->foo(), CANARY_VALUE);
+            locked++;
+          } catch (const kl::Exception&) {
+            EXPECT_TRUE(copy.expired());
+          }
+        }
+      });
+    }
+    ptr.reset();
+    for (auto& thread: threads) {
+      thread.join();
+    }
+    EXPECT_TRUE(weak.expired());
+    EXPECT_EQ(deletion_count, round + 1);
+  }
+}
+
+namespace {
+class Stream : public kl::RefCounted<Stream> {
+public:
+  virtual ~Stream() { deletion_count++; }
+  virtual int read() { return 0; }
+  // objects can hand out references to themselves
+  kl::IntrusivePointer<Stream> self() { return kl::IntrusivePointer<Stream>(this); }
+};
+
+class FileStream : public Stream {
+  int m_value;
+
+public:
+  explicit FileStream(int value) : m_value(value) { creation_count++; }
+  ~FileStream() override { deleter_count++; }
+  int read() override { return m_value; }
+};
+
+struct alignas(64) Block : kl::RefCounted<Block, kl::RefCounting::Atomic> {
+  int64_t value = 7;
+};
+} // namespace
+
+TEST_F(KLMem, intrusive_pointer) {
+  {
+    kl::IntrusivePointer<Stream> stream = kl::make_intrusive<FileStream>(42);
+    ASSERT_EQ(creation_count, 1);
+    ASSERT_EQ(stream->read(), 42);
+    ASSERT_EQ(stream->reference_count(), 1);
+    {
+      auto self = stream->self();
+      ASSERT_EQ(self, stream);
+      ASSERT_EQ(stream->reference_count(), 2);
+      kl::IntrusivePointer<Stream> moved(std::move(self));
+      ASSERT_FALSE(self);
+      ASSERT_EQ(stream->reference_count(), 2);
+      moved = stream;
+      moved = moved;
+      ASSERT_EQ(stream->reference_count(), 2);
+    }
+    ASSERT_EQ(stream->reference_count(), 1);
+    ASSERT_EQ(deletion_count, 0);
+  }
+  ASSERT_EQ(deletion_count, 1);
+  ASSERT_EQ(deleter_count, 1);
+
+  kl::IntrusivePointer<Stream> empty;
+  ASSERT_EQ(empty, nullptr);
+  ASSERT_THROW(empty->read(), kl::Exception);
+  // assigning a pointer held by the object being released
+  struct Node : kl::RefCounted<Node> {
+    kl::IntrusivePointer<Node> next;
+  };
+  auto head = kl::make_intrusive<Node>();
+  head->next = kl::make_intrusive<Node>();
+  head = head->next;
+  ASSERT_EQ(head->reference_count(), 1);
+  ASSERT_EQ(head->next, nullptr);
+  // and moving it
+  head->next = kl::make_intrusive<Node>();
+  head = std::move(head->next);
+  ASSERT_EQ(head->reference_count(), 1);
+  ASSERT_EQ(head->next, nullptr);
+}
+
+TEST_F(KLMem, atomic_intrusive_pointer) {
+  auto block = kl::make_intrusive<Block>();
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(block.get()) % 64, 0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 10000; i++) {
+        auto copy = block;
+        ASSERT_EQ(copy->value, 7);
+      }
+    });
+  }
+  for (auto& thread: threads) {
+    thread.join();
+  }
+  ASSERT_EQ(block->reference_count(), 1);
+}
+
+TEST_F(KLMem, object_pool) {
+  kl::ObjectPool pool(24);
+  ASSERT_EQ(pool.block_size(), 32);
+  ASSERT_THROW(pool.allocate(33), kl::Exception);
+  ASSERT_THROW(kl::ObjectPool(kl::ObjectPool::MaxBlockSize + 1), kl::Exception);
+
+  // blocks are distinct, aligned, and reused once released
+  std::vector<void*> blocks;
+  for (int i = 0; i < 5000; i++) {
+    blocks.push_back(pool.allocate(24));
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(blocks.back()) % kl::ObjectPool::BlockAlignment, 0);
+  }
+  std::sort(blocks.begin(), blocks.end());
+  ASSERT_EQ(std::adjacent_find(blocks.begin(), blocks.end()), blocks.end());
+  auto last = blocks.back();
+  for (auto block: blocks) {
+    kl::ObjectPool::release(block);
+  }
+  ASSERT_EQ(pool.allocate(32), last);
+  kl::ObjectPool::release(last);
+
+  // blocks released on other threads go back to the pool, in batches
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&pool, t, &blocks] {
+      for (size_t i = t; i < blocks.size(); i += 4) {
+        blocks[i] = pool.allocate(8);
+      }
+    });
+  }
+  for (auto& thread: threads) {
+    thread.join();
+  }
+  std::thread([&blocks] {
+    for (auto block: blocks) {
+      kl::ObjectPool::release(block);
+    }
+  }).join();
+
+  auto& sized = kl::SizedObjectPools::shared();
+  ASSERT_EQ(sized.pool_for(1).block_size(), 16);
+  ASSERT_EQ(sized.pool_for(17).block_size(), 32);
+  ASSERT_EQ(sized.pool_for(kl::ObjectPool::MaxBlockSize).block_size(), kl::ObjectPool::MaxBlockSize);
+  ASSERT_THROW(sized.allocate(kl::ObjectPool::MaxBlockSize + 1), kl::Exception);
+}
+
+TEST_F(KLMem, pooled_pointers) {
+  kl::ObjectPool pool(kl::ShareableBlockSize<A>);
+  {
+    auto unique = kl::make_ptr<A>(pool, 1);
+    auto shareable = kl::make_shareable<A>(pool);
+    auto mutable_shareable = kl::make_mutable_shareable<A>(kl::SizedObjectPools::shared());
+    auto atomic = kl::make_atomic_shareable<A>(pool);
+    kl::WeakPointer<A, kl::PoolDeleter<A>> weak(mutable_shareable);
+    EXPECT_EQ(unique->foo(), CANARY_VALUE);
+    EXPECT_EQ(weak.lock()->foo(), CANARY_VALUE);
+    EXPECT_EQ(atomic->foo(), CANARY_VALUE);
+    EXPECT_EQ(creation_count, 4);
+    mutable_shareable.reset();
+    EXPECT_EQ(deletion_count, 1);
+    EXPECT_TRUE(weak.expired());
+  }
+  EXPECT_EQ(deletion_count, 4);
+
+  // a constructor throwing returns the block
+  struct Failing {
+    Failing() { throw kl::Exception("Construction failed"); }
+  };
+  auto block = pool.allocate(1);
+  kl::ObjectPool::release(block);
+  EXPECT_THROW(kl::make_ptr<Failing>(pool), kl::Exception);
+  EXPECT_EQ(pool.allocate(1), block);
+  kl::ObjectPool::release(block);
+}
+
+TEST_F(KLMem, pool_block_sizes) {
+  // a multiple of the block alignment, leaving no room for the counts
+  struct Message {
+    int64_t id = 1;
+    int64_t payload = 2;
+  };
+  kl::ObjectPool pool(sizeof(Message));
+  ASSERT_EQ(pool.block_size(), sizeof(Message));
+  EXPECT_EQ(kl::make_ptr<Message>(pool)->id, 1);
+  EXPECT_THROW(kl::make_shareable<Message>(pool), kl::Exception);
+  EXPECT_THROW(kl::make_atomic_mutable_shareable<Message>(pool), kl::Exception);
+
+  kl::ObjectPool shareable_pool(kl::ShareableBlockSize<Message>);
+  EXPECT_EQ(kl::make_shareable<Message>(shareable_pool)->payload, 2);
+  EXPECT_EQ(kl::make_atomic_mutable_shareable<Message>(shareable_pool)->payload, 2);
+}
+
+TEST_F(KLMem, allocation_stats) {
+  using kl::AllocationCategory;
+  auto text = kl::allocation_stats(AllocationCategory::Text);
+  auto array = kl::allocation_stats(AllocationCategory::Array);
+  auto pointer = kl::allocation_stats(AllocationCategory::Pointer);
+  {
+    kl::Text long_text("Hello world, 16!");
+    kl::Array<int64_t> items(kl::TagReserve{}, 4);
+    items.reserve(100);
+    auto unique = kl::make_ptr<A>();
+    auto moved = std::move(unique);
+    auto shareable = kl::make_mutable_shareable<A>();
+    kl::WeakPointer<A> weak(shareable);
+    shareable.reset();
+
+    auto now = kl::allocation_stats(AllocationCategory::Array);
+    if constexpr (!kl::AllocationStatsEnabled) {
+      EXPECT_EQ(now.allocations, 0);
+      EXPECT_EQ(now.live_bytes, 0);
+      return;
+    }
+    EXPECT_EQ(now.allocations - array.allocations, 2);
+    EXPECT_EQ(now.releases - array.releases, 1);
+    EXPECT_EQ(now.live_bytes - array.live_bytes, 800);
+    EXPECT_GE(now.peak_bytes, array.live_bytes + 800);
+    EXPECT_EQ(now.sizes[5] - array.sizes[5], 1); // 32 bytes
+    EXPECT_EQ(now.sizes[9] - array.sizes[9], 1); // 800 bytes
+
+    now = kl::allocation_stats(AllocationCategory::Text);
+    EXPECT_EQ(now.allocations - text.allocations, 1);
+    EXPECT_GT(now.live_bytes - text.live_bytes, 16);
+
+    // the shareable block stays allocated for the weak pointer
+    now = kl::allocation_stats(AllocationCategory::Pointer);
+    EXPECT_EQ(now.allocations - pointer.allocations, 2);
+    EXPECT_EQ(now.releases - pointer.releases, 0);
+    EXPECT_EQ(now.live_bytes - pointer.live_bytes,
+              static_cast<int64_t>(sizeof(A) + sizeof(kl::RefCountedValue<A>)));
+  }
+  EXPECT_EQ(kl::allocation_stats(AllocationCategory::Text).live_bytes, text.live_bytes);
+  EXPECT_EQ(kl::allocation_stats(AllocationCategory::Array).live_bytes, array.live_bytes);
+  EXPECT_EQ(kl::allocation_stats(AllocationCategory::Pointer).live_bytes, pointer.live_bytes);
+  EXPECT_EQ(kl::allocation_stats(AllocationCategory::Pointer).releases - pointer.releases, 2);
+
+  // only objects of make_ptr are counted, once, however their ownership moves
+  pointer = kl::allocation_stats(AllocationCategory::Pointer);
+  {
+    kl::UniquePointer<A> unowned(new A());
+    auto made = kl::make_ptr<A>();
+    kl::UniquePointer<A> rewrapped(made.release());
+    auto now = kl::allocation_stats(AllocationCategory::Pointer);
+    EXPECT_EQ(now.allocations - pointer.allocations, 1);
+    EXPECT_EQ(now.releases - pointer.releases, 1);
+    EXPECT_EQ(now.live_bytes, pointer.live_bytes);
+  }
+  auto now = kl::allocation_stats(AllocationCategory::Pointer);
+  EXPECT_EQ(now.allocations - pointer.allocations, 1);
+  EXPECT_EQ(now.releases - pointer.releases, 1);
+  EXPECT_EQ(now.live_bytes, pointer.live_bytes);
 }
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <kl/ds/small_array.hpp>
+#include <kl/memory.hpp>
+#include <kl/text.hpp>
+#include <string>
+
+using namespace kl;
+
+TEST(klsmallarray, construction) {
+  SmallArray<int, 4> a;
+  EXPECT_EQ(a.size(), 0);
+  EXPECT_EQ(a.reserved(), 4);
+  EXPECT_TRUE(a.is_inline());
+  SmallArray<int, 4> b(TagBuild{}, 3, 7);
+  EXPECT_EQ(b.size(), 3);
+  EXPECT_EQ(b[-1], 7);
+  EXPECT_TRUE(b.is_inline());
+  SmallArray<int, 4> c(TagReserve{}, 10);
+  EXPECT_EQ(c.size(), 0);
+  EXPECT_EQ(c.reserved(), 10);
+  EXPECT_FALSE(c.is_inline());
+  SmallArray<int, 4> d(TagNoInit{}, 2);
+  EXPECT_EQ(d.size(), 2);
+  SmallArray<int, 4> e{1, 2, 3, 4, 5};
+  EXPECT_EQ(e.size(), 5);
+  EXPECT_FALSE(e.is_inline());
+  EXPECT_EQ(e[Cursor(3)], 4);
+  EXPECT_THROW(e[Cursor(-1)], Exception);
+  EXPECT_THROW(e[5], Exception);
+  EXPECT_TRUE(e.valid(e.last()));
+  EXPECT_FALSE(e.valid(Cursor(5)));
+}
+
+TEST(klsmallarray, spill_and_growth) {
+  SmallArray<std::string, 2> a;
+  a.push_back("a");
+  a.emplace_back("b");
+  EXPECT_TRUE(a.is_inline());
+  a.push_back("c");
+  EXPECT_FALSE(a.is_inline());
+  EXPECT_EQ(a.reserved(), grown_capacity(2, 3));
+  for (int i = 0; i < 20; i++) {
+    a.push_back(std::to_string(i));
+  }
+  EXPECT_EQ(a.size(), 23);
+  EXPECT_EQ(a[2], "c");
+  EXPECT_EQ(a[-1], "19");
+  a.insert(0, "first");
+  a.remove_at(1);
+  EXPECT_EQ(a[0], "first");
+  EXPECT_EQ(a[1], "b");
+  a.clear();
+  EXPECT_EQ(a.size(), 0);
+}
+
+TEST(klsmallarray, copy_and_move) {
+  SmallArray<Text, 3> inline_texts{"one"_t, "two"_t};
+  auto copy = inline_texts;
+  EXPECT_EQ(copy[1], "two"_t);
+  SmallArray<Text, 3> moved = std::move(inline_texts);
+  EXPECT_TRUE(moved.is_inline());
+  EXPECT_EQ(moved.size(), 2);
+  EXPECT_EQ(inline_texts.size(), 0);
+
+  SmallArray<UniquePointer<int>, 2> heap;
+  for (int i = 0; i < 5; i++) {
+    heap.push_back(make_ptr<int>(i));
+  }
+  auto data = heap.data();
+  SmallArray<UniquePointer<int>, 2> taken = std::move(heap);
+  EXPECT_EQ(taken.data(), data);
+  EXPECT_EQ(*taken[4], 4);
+  EXPECT_TRUE(heap.is_inline());
+  heap.push_back(make_ptr<int>(9));
+  heap = std::move(taken);
+  EXPECT_EQ(heap.size(), 5);
+  taken = std::move(heap);
+  EXPECT_EQ(*taken[0], 0);
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <kl/ds/soa_array.hpp>
+#include <kl/text.hpp>
+#include <numeric>
+#include <string>
+
+using namespace kl;
+
+TEST(klsoaarray, construction) {
+  SoAArray<int, double> a;
+  EXPECT_EQ(a.size(), 0);
+  EXPECT_EQ(a.reserved(), 0);
+  EXPECT_TRUE(a.column<0>().empty());
+  SoAArray<int, double> b(TagBuild{}, 5);
+  EXPECT_EQ(b.size(), 5);
+  EXPECT_EQ(b[4].get<0>(), 0);
+  EXPECT_EQ(b[-1].get<1>(), 0.0);
+  SoAArray<int, double> c(TagReserve{}, 10);
+  EXPECT_EQ(c.size(), 0);
+  EXPECT_EQ(c.reserved(), 10);
+  EXPECT_THROW(c[0], Exception);
+  EXPECT_THROW(b[Cursor(-1)], Exception);
+  EXPECT_TRUE(b.valid(b.last()));
+  EXPECT_FALSE(b.valid(Cursor(5)));
+}
+
+TEST(klsoaarray, rows_and_columns) {
+  SoAArray<int64_t, Text, double> items;
+  Array<int64_t> same_growth;
+  for (int64_t i = 0; i < 100; i++) {
+    auto row = items.push_back(i, Text(std::to_string(i).c_str()), i * 0.5);
+    EXPECT_EQ(row.index(), i);
+    same_growth.push_back(i);
+    EXPECT_EQ(items.reserved(), same_growth.reserved());
+  }
+  auto [id, name, weight] = items[Cursor(42)];
+  EXPECT_EQ(id, 42);
+  EXPECT_EQ(name, "42"_t);
+  EXPECT_EQ(weight, 21.0);
+  weight = -1;
+  EXPECT_EQ(items[42].get<2>(), -1.0);
+  items[-1].get<1>() = "last"_t;
+
+  auto ids = items.column<0>();
+  EXPECT_EQ(std::accumulate(ids.begin(), ids.end(), int64_t{0}), 4950);
+  TSize rows = 0;
+  for (auto row: items) {
+    EXPECT_EQ(row.get<0>(), rows++);
+  }
+  EXPECT_EQ(rows, 100);
+  const auto& view = items;
+  EXPECT_EQ(view.column<1>()[99], "last"_t);
+  static_assert(std::is_same_v<decltype(view[0].get<1>()), const Text&>);
+}
+
+TEST(klsoaarray, insert_remove_copy_move) {
+  SoAArray<std::string, int> items;
+  items.push_back("b", 2);
+  items.insert(0, "a", 1);
+  items.insert(2, "d", 4);
+  items.insert(2, "c", 3);
+  ASSERT_EQ(items.size(), 4);
+  for (TSize i = 0; i < items.size(); i++) {
+    EXPECT_EQ(items[i].get<0>(), std::string(1, static_cast<char>('a' + i)));
+    EXPECT_EQ(items[i].get<1>(), i + 1);
+  }
+  EXPECT_THROW(items.insert(5, "x", 0), Exception);
+  items.remove_at(1);
+  items.remove_at(-1);
+  EXPECT_EQ(items.size(), 2);
+  EXPECT_EQ(items[1].get<0>(), "c");
+
+  auto copy = items;
+  copy.push_back(std::string(100, 'e'), 5);
+  EXPECT_EQ(items.size(), 2);
+  EXPECT_EQ(copy[-1].get<0>(), std::string(100, 'e'));
+  SoAArray<std::string, int> moved(std::move(copy));
+  EXPECT_EQ(copy.size(), 0);
+  EXPECT_EQ(moved.size(), 3);
+  items = moved;
+  moved = std::move(items);
+  EXPECT_EQ(moved.column<1>()[2], 5);
+  moved.clear();
+  EXPECT_EQ(moved.size(), 0);
+  EXPECT_GE(moved.reserved(), 3);
+}
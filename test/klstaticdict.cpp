@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include <kl/ds/static_dict.hpp>
+#include <string>
+
+using namespace kl;
+
+namespace {
+
+enum class Header { Accept, ContentLength, ContentType, Cookie, Host, UserAgent, Connection, Authorization };
+
+constexpr Pair<Text, Header> HeaderNames[] = {{"accept"_t, Header::Accept},
+                                              {"content-length"_t, Header::ContentLength},
+                                              {"content-type"_t, Header::ContentType},
+                                              {"cookie"_t, Header::Cookie},
+                                              {"host"_t, Header::Host},
+                                              {"user-agent"_t, Header::UserAgent},
+                                              {"connection"_t, Header::Connection},
+                                              {"authorization"_t, Header::Authorization}};
+constexpr StaticDict<Header, 8> Headers(HeaderNames);
+
+static_assert(Headers.size() == 8);
+static_assert(Headers["host"_t] == Header::Host);
+static_assert(Headers["content-type"] == Header::ContentType);
+static_assert(Headers.has("cookie"_t));
+static_assert(!Headers.has("content"_t));
+static_assert(!Headers.has(""));
+static_assert(Headers.get("referer"_t, Header::Accept) == Header::Accept);
+static_assert(Headers.begin()->first == "accept"_t);
+
+constexpr Pair<Text, int> SingleName[] = {{"only"_t, 1}};
+constexpr StaticDict<int, 1> Single(SingleName);
+static_assert(Single["only"] == 1 && !Single.has("other"));
+
+} // namespace
+
+TEST(klstaticdict, runtime_lookups) {
+  std::string name = "user-agent";
+  EXPECT_EQ(Headers[name.c_str()], Header::UserAgent);
+  EXPECT_EQ(Headers[Text(name.data(), static_cast<TSize>(name.size()))], Header::UserAgent);
+  EXPECT_EQ(Headers.get_opt(std::string_view("authorization")), Header::Authorization);
+  EXPECT_EQ(Headers.get_opt(std::string_view("authorizatio")), std::nullopt);
+  EXPECT_THROW(Headers["x-forwarded-for"], Exception);
+  for (const auto& [key, value]: Headers) {
+    EXPECT_EQ(Headers[key.to_view()], value);
+  }
+
+  // built at runtime, with enough keys to need several pilots per bucket
+  constexpr TSize Count = 300;
+  Pair<Text, int> items[Count];
+  for (int i = 0; i < Count; i++) {
+    auto key = "keyword-" + std::to_string(i);
+    items[i] = {Text(key.data(), static_cast<TSize>(key.size())), i};
+  }
+  StaticDict<int, Count> keywords(items);
+  for (int i = 0; i < Count; i++) {
+    auto key = "keyword-" + std::to_string(i);
+    ASSERT_EQ(keywords[std::string_view(key)], i);
+  }
+  EXPECT_FALSE(keywords.has("keyword-300"));
+
+  items[1] = items[0];
+  EXPECT_THROW((StaticDict<int, Count>(items)), Exception);
+}
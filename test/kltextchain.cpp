@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "kl/text/chain.hpp"
+#include <random>
+#include <string>
+
+using namespace kl;
+
+TEST(kltextchain, build_and_flatten) {
+  TextChain chain{"HTTP/1.1 200 OK\r\n"_t, "Content-Type: ", "text/plain"};
+  EXPECT_EQ(chain.size(), 41);
+  EXPECT_EQ(chain.segments().size(), 3);
+  auto first = chain.to_text();
+  EXPECT_EQ(first, "HTTP/1.1 200 OK\r\nContent-Type: text/plain"_t);
+  EXPECT_EQ(chain.to_text().begin(), first.begin()); // cached
+
+  chain += "\r\n"_t;
+  chain.add("Content-Length: 5\r\n\r\nhello"_t);
+  Text second = chain;
+  EXPECT_EQ(second, "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 5\r\n\r\nhello"_t);
+  EXPECT_EQ(first, "HTTP/1.1 200 OK\r\nContent-Type: text/plain"_t); // earlier results are left alone
+
+  TextChain copy(chain);
+  copy += "!";
+  chain += "?";
+  EXPECT_TRUE(copy.to_text().ends_with("hello!"));
+  EXPECT_TRUE(chain.to_text().ends_with("hello?"));
+  chain.add(chain);
+  EXPECT_EQ(chain.size(), 2 * copy.size());
+
+  chain.clear();
+  EXPECT_EQ(chain.size(), 0);
+  EXPECT_EQ(chain.to_text(), ""_t);
+  EXPECT_EQ(TextChain{"single segment, returned as it is"_t}.to_text().begin(),
+            "single segment, returned as it is"_t.begin());
+}
+
+TEST(kltextchain, join) {
+  TextChain chain{"one", "two", "", "three"};
+  EXPECT_EQ(chain.join(), "onetwothree"_t);
+  EXPECT_EQ(chain.join(','), "one,two,,three"_t);
+  EXPECT_EQ(chain.join(", ", "[", "]"), "[one, two, , three]"_t);
+  EXPECT_EQ(TextChain{}.join(", ", "[", "]"), "[]"_t);
+  EXPECT_EQ(TextChain{"alone"}.join(", ", "[", "]"), "[alone]"_t);
+}
+
+TEST(kltextchain, indexed_access) {
+  std::mt19937 rng(17);
+  std::string expected;
+  TextChain chain;
+  for (int i = 0; i < 300; i++) {
+    std::string segment(rng() % 40, 'a');
+    for (auto& c: segment) {
+      c = static_cast<char>('a' + rng() % 3);
+    }
+    expected += segment;
+    chain += Text(segment.data(), static_cast<TSize>(segment.size()));
+    if (i == 150) {
+      EXPECT_EQ(chain.to_text().to_view(), expected); // part of the chain flattened
+    }
+  }
+  auto size = static_cast<TSize>(expected.size());
+  ASSERT_EQ(chain.size(), size);
+  for (TSize i = 0; i < size; i += 7) {
+    EXPECT_EQ(chain[i], expected[i]);
+  }
+  EXPECT_EQ(chain[-1], expected.back());
+  EXPECT_THROW(chain[size], Exception);
+
+  for (int i = 0; i < 500; i++) {
+    auto start = static_cast<TSize>(rng() % size);
+    auto len = static_cast<TSize>(rng() % 100);
+    EXPECT_EQ(chain.sublen(start, len).to_view(), std::string_view(expected).substr(start, len));
+  }
+  EXPECT_EQ(chain.sublen(size, 5), ""_t);
+  EXPECT_EQ(chain.sublen(-1, 5), ""_t);
+
+  for (const char* needle: {"a", "abc", "cab", "aaaa", "bcabca", "ccccccc"}) {
+    std::string_view view(needle);
+    size_t from = 0;
+    for (TSize occurence = 1; occurence < 40; occurence++) {
+      auto found = expected.find(view, from);
+      auto actual = chain.pos(Text(needle), occurence);
+      if (found == std::string::npos) {
+        EXPECT_EQ(actual, std::nullopt) << needle << " #" << occurence;
+        break;
+      }
+      EXPECT_EQ(actual, static_cast<TSize>(found)) << needle << " #" << occurence;
+      from = found + view.size();
+    }
+  }
+  EXPECT_EQ(chain.pos('c', 25), static_cast<TSize>(Text(expected.data(), size).pos('c', 25).value()));
+  EXPECT_EQ(chain.pos('z'), std::nullopt);
+}
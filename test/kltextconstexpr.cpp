@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "kl/text.hpp"
+
+using namespace kl;
+
+namespace {
+
+constexpr Text Request = "  GET /api/v1/users?id=42 HTTP/1.1\r\n"_t;
+
+static_assert(Request.size() == 36);
+static_assert(Request[2] == 'G');
+static_assert(Request[-1] == '\n');
+static_assert(Request.trim() == "GET /api/v1/users?id=42 HTTP/1.1"_t);
+static_assert(Request.trim_left().starts_with("GET "_t));
+static_assert(Request.trim_right().ends_with("HTTP/1.1"_t));
+static_assert(Request.trim().starts_with('G') && Request.trim().ends_with('1'));
+static_assert(Request.contains('?') && !Request.contains('#'));
+static_assert(Request.pos('/') == 6);
+static_assert(Request.pos('/', 4) == 30);
+static_assert(Request.pos('/', 5) == std::nullopt);
+static_assert(Request.pos("v1"_t) == 11);
+static_assert(Request.pos("HTTP"_t) == 26);
+static_assert(Request.pos("ftp"_t) == std::nullopt);
+static_assert(Request.last_pos('/') == 30);
+static_assert(Request.count('/') == 4);
+static_assert(Request.sublen(6, 4) == "/api"_t);
+static_assert(Request.subpos(6, 9) == "/api"_t);
+static_assert(Request.skip(26).skip(" HTTP/"_t.to_view()) == "1.1\r\n"_t);
+static_assert(""_t.trim() == Text{});
+
+constexpr auto Line = Request.trim();
+constexpr auto Method = Line.split_next_char(' ');
+static_assert(Method.first == "GET"_t);
+static_assert(Method.second.split_next_char('?').first == "/api/v1/users"_t);
+static_assert(Line.split_next_char(' ', SplitDirection::KeepLeft).first == "GET "_t);
+static_assert(Line.split_next_char(' ', SplitDirection::KeepRight).second == " /api/v1/users?id=42 HTTP/1.1"_t);
+static_assert(Line.split_next_char('#').second == ""_t);
+
+static_assert("abc"_t < "abd"_t);
+static_assert("abc"_t != "abcd"_t);
+static_assert(("b"_t <=> "a"_t) == std::strong_ordering::greater);
+
+// hashes computed by the compiler match the runtime ones, and the ones cached in literals
+static_assert(Method.first.hash() == hash_bytes("GET", 3));
+static_assert("/api/v1/users"_t.hash() == TextLiteral("/api/v1/users").base.hash);
+
+// A route table validated at compile time: every route is absolute and has no trailing slash.
+constexpr Text Routes[] = {"/"_t, "/users"_t, "/users/settings"_t, "/metrics"_t};
+
+constexpr bool valid_routes() {
+  for (const auto& route: Routes) {
+    if (!route.starts_with('/') || (route.size() > 1 && route.ends_with('/'))) {
+      return false;
+    }
+  }
+  return true;
+}
+static_assert(valid_routes());
+
+constexpr TSize route_index(const Text& path) {
+  for (TSize i = 0; i < static_cast<TSize>(std::size(Routes)); i++) {
+    if (Routes[i] == path) {
+      return i;
+    }
+  }
+  return -1;
+}
+static_assert(route_index("/users/settings"_t) == 2);
+static_assert(route_index("/nope"_t) == -1);
+
+} // namespace
+
+TEST(kltextconstexpr, matches_runtime) {
+  // the same operations, at runtime, on heap and small texts
+  Text request(Request.begin(), Request.size());
+  EXPECT_EQ(request.trim(), Line);
+  EXPECT_EQ(request.pos("HTTP"_t), Request.pos("HTTP"_t));
+  EXPECT_EQ(request.count('/'), Request.count('/'));
+  EXPECT_EQ(request.hash(), Request.hash());
+  auto [method, rest] = Text(Line.begin(), Line.size()).split_next_char(' ');
+  EXPECT_EQ(method, Method.first);
+  EXPECT_EQ(rest, Method.second);
+  EXPECT_EQ(route_index(Text("/metrics")), 3);
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "kl/text.hpp"
+#include "text_search.hpp"
+#include <random>
+#include <string>
+
+using namespace kl;
+
+TEST(kltextsearch, pos_and_count) {
+  Text t("a,b,,c,dd,e and some more text to leave the small-text range,");
+  EXPECT_EQ(t.pos(','), 1);
+  EXPECT_EQ(t.pos(',', 3), 4);
+  EXPECT_EQ(t.pos(',', 0), std::nullopt);
+  EXPECT_EQ(t.pos('z'), std::nullopt);
+  EXPECT_EQ(t.last_pos(','), t.size() - 1);
+  EXPECT_EQ(t.last_pos('z'), std::nullopt);
+  EXPECT_EQ(t.count(','), 6);
+  EXPECT_TRUE(t.contains('d'));
+  EXPECT_FALSE(t.contains('z'));
+  EXPECT_EQ(t.pos("dd"), 7);
+  EXPECT_EQ(t.pos("e", 2), 19);
+  EXPECT_EQ(t.pos("small-text"), 44);
+  EXPECT_EQ(t.pos("absent"), std::nullopt);
+  EXPECT_EQ(t.pos(""), std::nullopt);
+  EXPECT_EQ(t[0], 'a');
+  EXPECT_EQ(t[-1], ',');
+  EXPECT_THROW(t[t.size()], Exception);
+  EXPECT_THROW(t[-t.size() - 1], Exception);
+}
+
+TEST(kltextsearch, trim_and_skip) {
+  Text t("  \t  some text in the middle of whitespace \r\n ");
+  EXPECT_EQ(t.trim(), "some text in the middle of whitespace");
+  EXPECT_EQ(t.trim_left(), "some text in the middle of whitespace \r\n ");
+  EXPECT_EQ(t.trim_right(), "  \t  some text in the middle of whitespace");
+  EXPECT_EQ(Text("   ").trim(), "");
+  EXPECT_EQ(Text("").trim(), "");
+  EXPECT_EQ(t.skip(5), "some text in the middle of whitespace \r\n ");
+  EXPECT_EQ(t.skip(" \tso"), "me text in the middle of whitespace \r\n ");
+  EXPECT_EQ(t.skip(1000), "");
+  EXPECT_TRUE(t.trim().starts_with("some"));
+  EXPECT_TRUE(t.trim().starts_with('s'));
+  EXPECT_TRUE(t.trim().ends_with("whitespace"));
+  EXPECT_TRUE(t.trim().ends_with('e'));
+  EXPECT_FALSE(t.starts_with("some"));
+  EXPECT_EQ(t.trim().sublen(5, 4), "text");
+  EXPECT_EQ(t.trim().subpos(5, 8), "text");
+  EXPECT_EQ(t.trim().sublen(32, 100), "space");
+  EXPECT_EQ(t.trim().sublen(100, 1), "");
+}
+
+TEST(kltextsearch, split) {
+  Text line("2024-01-01T00:00:00 host-0042 service[123]: request took 15ms");
+  auto [date, rest] = line.split_next_char(' ');
+  EXPECT_EQ(date, "2024-01-01T00:00:00");
+  EXPECT_EQ(rest, "host-0042 service[123]: request took 15ms");
+  auto [left, right] = line.split_next_char(' ', SplitDirection::KeepLeft);
+  EXPECT_EQ(left, "2024-01-01T00:00:00 ");
+  auto [left2, right2] = line.split_next_char(' ', SplitDirection::KeepRight);
+  EXPECT_EQ(right2, " host-0042 service[123]: request took 15ms");
+  auto [all, none] = line.split_next_char('|');
+  EXPECT_EQ(all, line);
+  EXPECT_EQ(none, "");
+
+  auto parts = line.split_by_char(' ');
+  ASSERT_EQ(parts.size(), 6);
+  EXPECT_EQ(parts[1], "host-0042");
+  EXPECT_EQ(parts[-1], "15ms");
+
+  Text csv(",a,,b,");
+  EXPECT_EQ(csv.split_by_char(',').size(), 2);
+  auto kept = csv.split_by_char(',', SplitEmpty::Keep);
+  ASSERT_EQ(kept.size(), 5);
+  EXPECT_EQ(kept[0], "");
+  EXPECT_EQ(kept[1], "a");
+  EXPECT_EQ(kept[2], "");
+  EXPECT_EQ(kept[3], "b");
+  EXPECT_EQ(kept[4], "");
+  EXPECT_EQ(Text().split_by_char(',', SplitEmpty::Keep).size(), 1);
+}
+
+TEST(kltextsearch, comparison) {
+  Text a("alpha beta gamma delta epsilon");
+  Text b("alpha beta gamma delta epsilon");
+  EXPECT_EQ(a, b);
+  EXPECT_NE(a, a.sublen(0, 5));
+  EXPECT_EQ(a.sublen(0, 5), "alpha");
+  EXPECT_LT(a.sublen(0, 5), a);
+  EXPECT_GT(Text("b"), a);
+}
+
+TEST(kltextsearch, kernels_match_scalar) {
+  const auto& scalar = text_search::scalar_kernels();
+  std::mt19937 rng(42); // NOLINT(cert-msc51-cpp)
+  std::uniform_int_distribution<int> letter(0, 5);
+  const std::string_view set{" \t\n\r"};
+  for (const auto* kernels: {&text_search::sse2_kernels(), &text_search::avx2_kernels()}) {
+    for (int length = 0; length < 200; length++) {
+      std::string data;
+      for (int i = 0; i < length; i++) {
+        data.push_back(" \tabc\n"[letter(rng)]);
+      }
+      auto b = data.data();
+      auto e = b + data.size();
+      for (char c: {'a', 'b', 'c', 'z'}) {
+        EXPECT_EQ(kernels->find_char(b, e, c), scalar.find_char(b, e, c)) << kernels->name;
+        EXPECT_EQ(kernels->find_last_char(b, e, c), scalar.find_last_char(b, e, c)) << kernels->name;
+        EXPECT_EQ(kernels->count_char(b, e, c), scalar.count_char(b, e, c)) << kernels->name;
+      }
+      EXPECT_EQ(kernels->find_first_not_of(b, e, set.data(), 4), scalar.find_first_not_of(b, e, set.data(), 4));
+      EXPECT_EQ(kernels->find_last_not_of(b, e, set.data(), 4), scalar.find_last_not_of(b, e, set.data(), 4));
+      for (const std::string_view needle: {"a", "ab", "abc", "c\na", "bb \t", "zz"}) {
+        EXPECT_EQ(kernels->find_text(b, e, needle.data(), static_cast<TSize>(needle.size())),
+                  scalar.find_text(b, e, needle.data(), static_cast<TSize>(needle.size())))
+            << kernels->name << " " << needle;
+      }
+    }
+  }
+  std::string long_data(20011, 'x');
+  for (size_t i = 0; i < long_data.size(); i += 3) {
+    long_data[i] = 'a';
+  }
+  auto b = long_data.data();
+  auto e = b + long_data.size();
+  EXPECT_EQ(text_search::sse2_kernels().count_char(b, e, 'a'), scalar.count_char(b, e, 'a'));
+  EXPECT_EQ(text_search::avx2_kernels().count_char(b, e, 'a'), scalar.count_char(b, e, 'a'));
+}
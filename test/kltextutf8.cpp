@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "kl/text.hpp"
+#include "text_utf8.hpp"
+#include <random>
+#include <string>
+
+using namespace kl;
+
+static_assert(utf8::count_valid("h\xC3\xA9llo", "h\xC3\xA9llo" + 6) == 5);
+static_assert(utf8::count_valid("\xED\xA0\x80", "\xED\xA0\x80" + 3) == -1); // surrogate
+static_assert(TextLiteral("na\xC3\xAFve caf\xC3\xA9").base.utf8 == 11);
+
+namespace {
+Text text(const std::string& value) { return {value.data(), static_cast<TSize>(value.size())}; }
+} // namespace
+
+TEST(kltextutf8, validation) {
+  for (const char* valid: {"", "plain ascii", "h\xC3\xA9llo", "\xE2\x82\xAC 100", "\xF0\x9F\x98\x80!", "\xEF\xBF\xBF",
+                           "\xF4\x8F\xBF\xBF", "\xED\x9F\xBF"}) {
+    EXPECT_TRUE(Text(valid).is_valid_utf8()) << valid;
+  }
+  for (const char* invalid: {"\x80", "abc\xC3", "\xC0\xAF", "\xE0\x9F\xBF", "\xED\xA0\x80", "\xF0\x8F\xBF\xBF",
+                             "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "\xFF", "\xE2\x82 100", "\xC3\xA9\xA9"}) {
+    EXPECT_FALSE(Text(invalid).is_valid_utf8()) << invalid;
+  }
+
+  std::string payload;
+  for (int i = 0; i < 20; i++) {
+    payload += "a payload with caf\xC3\xA9, \xE2\x82\xAC and \xF0\x9F\x98\x80 in it; ";
+  }
+  auto value = text(payload);
+  EXPECT_TRUE(value.is_valid_utf8());
+  EXPECT_TRUE(value.is_valid_utf8()); // cached
+  EXPECT_FALSE(value.sublen(19, 40).is_valid_utf8()); // cuts the é in half
+  EXPECT_FALSE(text(payload + "\xF0\x9F\x98").is_valid_utf8());
+  EXPECT_TRUE("a literal, checked at compile time: \xE2\x9C\x93"_t.is_valid_utf8());
+
+  auto ascii = text(std::string(100, 'x'));
+  EXPECT_TRUE(ascii.is_valid_utf8());
+  EXPECT_TRUE(ascii.sublen(10, 50).is_valid_utf8());
+  EXPECT_EQ(ascii.sublen(10, 50).utf8_length(), 50);
+}
+
+TEST(kltextutf8, code_points) {
+  std::string payload;
+  for (int i = 0; i < 20; i++) {
+    payload += "caf\xC3\xA9 \xE2\x82\xAC\xF0\x9F\x98\x80|";
+  }
+  auto value = text(payload);
+  EXPECT_EQ(value.utf8_length(), 20 * 8);
+  EXPECT_EQ(value.utf8_length(), 20 * 8);
+  EXPECT_EQ(Text("h\xC3\xA9llo").utf8_length(), 5);
+  EXPECT_EQ(""_t.utf8_length(), 0);
+
+  EXPECT_EQ(value.utf8_sublen(3, 3), "\xC3\xA9 \xE2\x82\xAC"_t);
+  EXPECT_EQ(value.utf8_sublen(6, 2), "\xF0\x9F\x98\x80|"_t);
+  EXPECT_EQ(value.utf8_sublen(8 * 19, 100), "caf\xC3\xA9 \xE2\x82\xAC\xF0\x9F\x98\x80|"_t);
+  EXPECT_EQ(value.utf8_sublen(8 * 20, 1), ""_t);
+  EXPECT_EQ(value.utf8_sublen(-1, 1), ""_t);
+  EXPECT_EQ(value.utf8_sublen(0, 0), ""_t);
+  EXPECT_EQ(text(std::string(100, 'x')).utf8_sublen(90, 20).size(), 10);
+}
+
+TEST(kltextutf8, kernels_match_scalar) {
+  const auto& scalar = text_utf8::scalar_kernels();
+  std::mt19937 rng(42);
+  const char* pieces[] = {"a", "z ", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\xED\x9F\xBF",
+                          "\xF4\x8F\xBF\xBF"};
+  const char* broken[] = {"\x80", "\xC3", "\xE2\x82", "\xF0\x9F\x98", "\xC0\x80", "\xED\xA0\x80", "\xF4\x90\x80\x80",
+                          "\xFE", "\xE0\x80\x80"};
+  for (const auto* variant: {&text_utf8::sse2_kernels(), &text_utf8::avx2_kernels()}) {
+    for (int round = 0; round < 2000; round++) {
+      std::string data;
+      auto count = rng() % 80;
+      for (size_t i = 0; i < count; i++) {
+        data += pieces[rng() % std::size(pieces)];
+      }
+      if (round % 2 == 1) {
+        data.insert(rng() % (data.size() + 1), broken[rng() % std::size(broken)]);
+      }
+      auto b = data.data();
+      auto e = b + data.size();
+      ASSERT_EQ(variant->validate(b, e), scalar.validate(b, e)) << variant->name << " " << data;
+      ASSERT_EQ(variant->validate(b, e), utf8::count_valid(b, e) >= 0) << variant->name << " " << data;
+      ASSERT_EQ(variant->count_code_points(b, e), scalar.count_code_points(b, e)) << variant->name;
+      auto skip = static_cast<TSize>(rng() % (count + 2));
+      ASSERT_EQ(variant->advance(b, e, skip), scalar.advance(b, e, skip)) << variant->name;
+    }
+  }
+}